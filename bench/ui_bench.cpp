@@ -0,0 +1,519 @@
+/**
+ * @file bench/ui_bench.cpp
+ * @brief this program measures the host (Linux) cost of menu navigation,
+ * drawing, text entry and settings I/O.
+ *
+ * For each case it reports the time per operation and the number of
+ * heap allocations and heap bytes allocated per operation, so
+ * regressions show up when menus or settings grow.
+ *
+ * usage: ui_bench [-t min_ms] [filter]
+ *     -t min_ms: run each case for at least min_ms milliseconds (default 200)
+ *     filter: only run the cases whose names contain this string
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifdef UI_BENCH_SETTINGS
+#include "setting_string_enum.h"
+#include "setting_flash_enum.h"
+#include "setting_number.h"
+#include "setting_bimap.h"
+#include "setting_list.h"
+#include "int_spinner_menu_item.h"
+#include "bimap_spinner_menu_item.h"
+#endif
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "mono_graphics_lib.h"
+#include "view_manager.h"
+#include "menu.h"
+#include "text_entry_box.h"
+#include "tusb.h"
+
+//--------------------------------------------------------------------+
+// Heap allocation counting
+//--------------------------------------------------------------------+
+static uint64_t num_allocs = 0;
+static uint64_t num_alloc_bytes = 0;
+
+static void* counted_malloc(size_t size)
+{
+    ++num_allocs;
+    num_alloc_bytes += size;
+    return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(size_t size)
+{
+    void* ptr = counted_malloc(size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+//--------------------------------------------------------------------+
+// Benchmark runner
+//--------------------------------------------------------------------+
+namespace
+{
+uint32_t min_run_ms = 200;
+const char* name_filter = nullptr;
+
+/**
+ * @brief call op() in batches of doubling size until a batch takes at least
+ * min_run_ms, then print the cost per call of the last batch
+ *
+ * @param name the name of the benchmark case
+ * @param op the operation to measure
+ */
+template<typename Op>
+void run(const char* name, Op&& op)
+{
+    if (name_filter && strstr(name, name_filter) == nullptr)
+        return;
+    op(); // warm up; the first call may allocate things that later calls reuse
+    uint64_t nops = 1;
+    for (;;) {
+        uint64_t allocs = num_allocs;
+        uint64_t bytes = num_alloc_bytes;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t idx = 0; idx < nops; idx++)
+            op();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        if (elapsed_ns >= min_run_ms * 1e6 || nops >= (1ull << 40)) {
+            printf("%-36s %12llu %12.1f %10.2f %10.1f\n", name, static_cast<unsigned long long>(nops),
+                elapsed_ns / nops, static_cast<double>(num_allocs - allocs) / nops,
+                static_cast<double>(num_alloc_bytes - bytes) / nops);
+            fflush(stdout);
+            return;
+        }
+        nops *= 2;
+    }
+}
+
+/**
+ * @brief move the current item one visible item down the menu until it
+ * reaches the last item, then one item up until it reaches the first item
+ */
+void bench_menu_nav(rppicomidi::Mono_graphics& screen, size_t nitems, bool hide_every_other, bool bitmap_cache)
+{
+    using namespace rppicomidi;
+    View_manager view_manager;
+    Menu menu{screen, 0, screen.get_font_12()};
+    for (size_t idx = 0; idx < nitems; idx++) {
+        char text[22];
+        snprintf(text, sizeof(text), "Item %d", static_cast<int>(idx));
+        auto item = new Menu_item(text, screen, screen.get_font_12());
+        item->set_hidden(hide_every_other && (idx % 2) == 1);
+        item->set_bitmap_cache_enabled(bitmap_cache);
+        menu.add_menu_item(item);
+    }
+    view_manager.push_view(&menu);
+    bool down = true;
+    char name[64];
+    snprintf(name, sizeof(name), "menu_nav/%zu%s%s", nitems, hide_every_other ? "/half_hidden" : "",
+        bitmap_cache ? "/bitmap_cache" : "");
+    run(name, [&]() {
+        int idx = menu.get_current_item_idx();
+        if (down)
+            view_manager.post_event(Ui_event{Ui_event::decrement, 1, false});
+        else
+            view_manager.post_event(Ui_event{Ui_event::increment, 1, false});
+        if (menu.get_current_item_idx() == idx)
+            down = !down;
+    });
+}
+
+void bench_menu_draw(rppicomidi::Mono_graphics& screen, size_t nitems, bool bitmap_cache)
+{
+    using namespace rppicomidi;
+    View_manager view_manager;
+    Menu menu{screen, 0, screen.get_font_12()};
+    for (size_t idx = 0; idx < nitems; idx++) {
+        char text[22];
+        snprintf(text, sizeof(text), "Item %d", static_cast<int>(idx));
+        auto item = new Menu_item(text, screen, screen.get_font_12());
+        item->set_bitmap_cache_enabled(bitmap_cache);
+        menu.add_menu_item(item);
+    }
+    view_manager.push_view(&menu);
+    view_manager.post_event(Ui_event{Ui_event::decrement, static_cast<uint32_t>(nitems / 2), false});
+    char name[64];
+    snprintf(name, sizeof(name), "menu_draw/%zu%s", nitems, bitmap_cache ? "/bitmap_cache" : "");
+    run(name, [&]() {
+        menu.draw();
+    });
+}
+
+/**
+ * @brief type characters into a Text_entry_box until it is full, then clear it
+ */
+void bench_text_entry(rppicomidi::Mono_graphics& screen, size_t max_chars)
+{
+    using namespace rppicomidi;
+    View_manager view_manager;
+    Text_entry_box box{screen, "Name", max_chars, "", nullptr, nullptr};
+    view_manager.push_view(&box);
+    size_t ntyped = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "text_entry_typing/%zu", max_chars);
+    run(name, [&]() {
+        if (ntyped == max_chars) {
+            box.set_text("");
+            box.set_cursor_to_end();
+            ntyped = 0;
+        }
+        view_manager.post_event(Ui_event{static_cast<uint8_t>(HID_KEY_A + ntyped % 26), 0, true});
+        ++ntyped;
+    });
+}
+
+/**
+ * @brief insert and delete a character at the start of the text in a
+ * Text_entry_box that is half full
+ */
+void bench_text_entry_edit(rppicomidi::Mono_graphics& screen, size_t max_chars)
+{
+    using namespace rppicomidi;
+    View_manager view_manager;
+    Text_entry_box box{screen, "Name", max_chars, "", nullptr, nullptr};
+    view_manager.push_view(&box);
+    std::string half(max_chars / 2, 'x');
+    box.set_text(half.c_str());
+    view_manager.post_event(Ui_event{static_cast<uint8_t>(HID_KEY_HOME), 0, true});
+    bool inserted = false;
+    char name[64];
+    snprintf(name, sizeof(name), "text_entry_edit/%zu", max_chars);
+    run(name, [&]() {
+        uint8_t key_code = inserted ? HID_KEY_BACKSPACE : HID_KEY_A;
+        view_manager.post_event(Ui_event{key_code, 0, true});
+        inserted = !inserted;
+    });
+}
+
+#ifdef UI_BENCH_SETTINGS
+template<typename T>
+void bench_bimap_find(const char* type_name, size_t npairs)
+{
+    using namespace rppicomidi;
+    Setting_bimap<T> bimap{"bimap", 0, 127};
+    for (size_t idx = 0; idx < npairs; idx++)
+        bimap.push_back(static_cast<T>(idx), static_cast<T>(npairs - 1 - idx));
+    T key = 0;
+    volatile int found = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "bimap_find/%s/%zu", type_name, npairs);
+    run(name, [&]() {
+        found = found + bimap.find(key, 0);
+        key = static_cast<T>((key + 1) % npairs);
+    });
+}
+
+/**
+ * @brief spin the value of a spinner menu item that is being edited up
+ * and down through its range
+ */
+template<typename Spinner, typename Add_spinner>
+void bench_spinner(rppicomidi::Mono_graphics& screen, const char* name, Add_spinner&& add_spinner)
+{
+    using namespace rppicomidi;
+    View_manager view_manager;
+    Menu menu{screen, 0, screen.get_font_12()};
+    add_spinner(menu);
+    view_manager.push_view(&menu);
+    view_manager.post_event(Ui_event{Ui_event::select});
+    int count = 0;
+    run(name, [&]() {
+        if ((count++ / 100) % 2 == 0)
+            view_manager.post_event(Ui_event{Ui_event::increment, 1, false});
+        else
+            view_manager.post_event(Ui_event{Ui_event::decrement, 1, false});
+    });
+}
+
+void bench_spinners(rppicomidi::Mono_graphics& screen)
+{
+    using namespace rppicomidi;
+    static Setting_number<int16_t> number{"number", -1000, 1000, 0};
+    auto get_fn = [](void* context) { return static_cast<Setting_number<int16_t>*>(context)->get(); };
+    auto incr_fn = [](void* context, int delta) { return static_cast<Setting_number<int16_t>*>(context)->incr(delta); };
+    bench_spinner<Int_spinner_menu_item<int16_t>>(screen, "spinner_redraw/int", [&](Menu& menu) {
+        menu.add_menu_item(new Int_spinner_menu_item<int16_t>("Tempo:", screen, screen.get_font_12(), 5, 4, false,
+            get_fn, incr_fn, &number, "bpm"));
+    });
+
+    static Setting_bimap<uint8_t> bimap{"bimap", 0, 127};
+    bimap.push_back(60, 64);
+    bench_spinner<Bimap_spinner_menu_item<uint8_t>>(screen, "spinner_redraw/bimap", [&](Menu& menu) {
+        menu.add_menu_item(new Bimap_spinner_menu_item<uint8_t>("Note ", screen, screen.get_font_12(), bimap, 0, 3, 2, false));
+    });
+}
+
+/**
+ * @brief serialize setting_ to a JSON string and then deserialize it back
+ */
+template<typename Setting>
+void bench_round_trip(const char* name, Setting& setting_)
+{
+    run(name, [&]() {
+        JSON_Value* root_value = json_value_init_object();
+        setting_.serialize(json_value_get_object(root_value));
+        char* settings_str = json_serialize_to_string(root_value);
+        json_value_free(root_value);
+        root_value = json_parse_string(settings_str);
+        json_free_serialized_string(settings_str);
+        bool ok = root_value && json_value_get_type(root_value) == JSONObject &&
+            setting_.deserialize(json_value_get_object(root_value));
+        json_value_free(root_value);
+        if (!ok) {
+            printf("%s: round trip failed\r\n", name);
+            exit(1);
+        }
+    });
+}
+
+/**
+ * @brief deserialize a setting from an already parsed JSON object, the way
+ * loading a preset does, to count the allocations the setting itself makes
+ */
+template<typename Setting>
+void bench_load(const char* name, Setting& setting_)
+{
+    JSON_Value* root_value = json_value_init_object();
+    setting_.serialize(json_value_get_object(root_value));
+    JSON_Object* root_object = json_value_get_object(root_value);
+    run(name, [&]() {
+        if (!setting_.deserialize(root_object)) {
+            printf("%s: load failed\r\n", name);
+            exit(1);
+        }
+    });
+    json_value_free(root_value);
+}
+
+static constexpr const char* channel_names[16] = {"Ch 1", "Ch 2", "Ch 3", "Ch 4", "Ch 5", "Ch 6", "Ch 7", "Ch 8",
+    "Ch 9", "Ch 10", "Ch 11", "Ch 12", "Ch 13", "Ch 14", "Ch 15", "Ch 16"};
+static constexpr rppicomidi::Flash_enum_values<16> channel_values{channel_names};
+
+/**
+ * @brief save and load a preset of 16 numbers, 4 enums and 2 maps of 16
+ * pairs as JSON text and in the binary settings format
+ */
+void bench_preset()
+{
+    using namespace rppicomidi;
+    std::vector<Setting_base*> settings;
+    char names[22][8];
+    for (int idx = 0; idx < 16; idx++) {
+        snprintf(names[idx], sizeof(names[idx]), "num%d", idx);
+        auto number = new Setting_number<int>{names[idx], -1000, 1000, 0};
+        number->set(idx * 37 - 300);
+        settings.push_back(number);
+    }
+    for (int idx = 0; idx < 4; idx++) {
+        snprintf(names[16 + idx], sizeof(names[0]), "enum%d", idx);
+        auto channel = new Setting_flash_enum{names[16 + idx], channel_values};
+        channel->set(static_cast<size_t>(idx * 5));
+        settings.push_back(channel);
+    }
+    for (int idx = 0; idx < 2; idx++) {
+        snprintf(names[20 + idx], sizeof(names[0]), "map%d", idx);
+        auto map = new Setting_bimap_fixed<uint8_t, 16>{names[20 + idx], 0, 127};
+        for (uint8_t pair = 0; pair < 16; pair++)
+            map->push_back(pair * 3, 127 - pair);
+        settings.push_back(map);
+    }
+    Setting_list list{settings.data(), settings.size()};
+
+    JSON_Value* root_value = json_value_init_object();
+    list.serialize(json_value_get_object(root_value));
+    char* json_str = json_serialize_to_string(root_value);
+    json_value_free(root_value);
+    run("load/preset_json", [&]() {
+        JSON_Value* parsed_value = json_parse_string(json_str);
+        bool ok = parsed_value && list.deserialize(json_value_get_object(parsed_value));
+        json_value_free(parsed_value);
+        if (!ok) {
+            printf("load/preset_json: load failed\r\n");
+            exit(1);
+        }
+    });
+
+    // read the text in 64 byte chunks, the way a load from flash would
+    run("load/preset_json_reader", [&]() {
+        Setting_list_json_reader reader{list};
+        size_t json_len = strlen(json_str);
+        for (size_t pos = 0; pos < json_len; pos += 64)
+            reader.feed(json_str + pos, json_len - pos < 64 ? json_len - pos : 64);
+        if (!reader.finish()) {
+            printf("load/preset_json_reader: load failed\r\n");
+            exit(1);
+        }
+    });
+
+    run("save/preset_json", [&]() {
+        JSON_Value* saved_value = json_value_init_object();
+        list.serialize(json_value_get_object(saved_value));
+        char* saved_str = json_serialize_to_string(saved_value);
+        json_value_free(saved_value);
+        json_free_serialized_string(saved_str);
+    });
+
+    // write the text in 64 byte chunks, the way a save to flash would
+    std::string saved_str;
+    saved_str.reserve(strlen(json_str));
+    auto store_chunk = [](void* context, const char* data, size_t len) {
+        static_cast<std::string*>(context)->append(data, len);
+        return true;
+    };
+    run("save/preset_json_writer", [&]() {
+        char chunk[64];
+        saved_str.clear();
+        Json_writer writer{chunk, sizeof(chunk), store_chunk, &saved_str};
+        if (!list.serialize(writer) || saved_str != json_str) {
+            printf("save/preset_json_writer: text differs from json_serialize_to_string()\r\n");
+            exit(1);
+        }
+    });
+
+    std::vector<uint8_t> binary(list.get_binary_size());
+    list.serialize(binary.data(), binary.size());
+    run("load/preset_binary", [&]() {
+        if (!list.deserialize(binary.data(), binary.size())) {
+            printf("load/preset_binary: load failed\r\n");
+            exit(1);
+        }
+    });
+    if (!name_filter || strstr("load/preset", name_filter))
+        printf("preset size: %zu bytes of JSON, %zu bytes of binary\n", strlen(json_str), binary.size());
+    json_free_serialized_string(json_str);
+    for (auto setting: settings)
+        delete setting;
+}
+
+void bench_settings()
+{
+    using namespace rppicomidi;
+    Setting_number<int> number{"number", -1000, 1000, 0};
+    number.set(-123);
+    bench_round_trip("round_trip/setting_number", number);
+
+    Setting_string_enum string_enum{"string_enum", {"Off", "Low", "Medium", "High"}};
+    string_enum.set(size_t{2});
+    bench_round_trip("round_trip/setting_string_enum", string_enum);
+
+    // the last value is the worst case for a linear search
+    Setting_string_enum channel_enum{"channel", {"Ch 1", "Ch 2", "Ch 3", "Ch 4", "Ch 5", "Ch 6", "Ch 7", "Ch 8",
+        "Ch 9", "Ch 10", "Ch 11", "Ch 12", "Ch 13", "Ch 14", "Ch 15", "Ch 16"}};
+    channel_enum.set(size_t{15});
+    bench_load("load/setting_string_enum/16", channel_enum);
+
+    Setting_flash_enum channel_flash_enum{"channel", channel_values};
+    channel_flash_enum.set(size_t{15});
+    bench_load("load/setting_flash_enum/16", channel_flash_enum);
+
+    Setting_bimap<uint8_t> bimap{"bimap", 0, 127};
+    for (uint8_t idx = 0; idx < 16; idx++)
+        bimap.push_back(idx, 127 - idx);
+    bench_round_trip("round_trip/setting_bimap/16", bimap);
+    bench_load("load/setting_bimap/16", bimap);
+
+    Setting_bimap_fixed<uint8_t, 16> bimap_fixed{"bimap", 0, 127};
+    for (uint8_t idx = 0; idx < 16; idx++)
+        bimap_fixed.push_back(idx, 127 - idx);
+    bench_load("load/setting_bimap_fixed/16", bimap_fixed);
+
+    bench_preset();
+}
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    for (int idx = 1; idx < argc; idx++) {
+        if (strcmp(argv[idx], "-t") == 0 && idx + 1 < argc)
+            min_run_ms = static_cast<uint32_t>(atoi(argv[++idx]));
+        else
+            name_filter = argv[idx];
+    }
+#ifdef UI_BENCH_SETTINGS
+    json_set_allocation_functions(counted_malloc, free);
+#endif
+    rppicomidi::Mono_graphics screen;
+    printf("%-36s %12s %12s %10s %10s\n", "benchmark", "ops", "ns/op", "allocs/op", "bytes/op");
+    for (size_t nitems : {10, 100, 1000, 10000}) {
+        bench_menu_nav(screen, nitems, false, false);
+        bench_menu_nav(screen, nitems, true, false);
+    }
+    bench_menu_nav(screen, 100, false, true);
+    for (size_t nitems : {10, 1000}) {
+        bench_menu_draw(screen, nitems, false);
+        bench_menu_draw(screen, nitems, true);
+    }
+    for (size_t max_chars : {64, 1024}) {
+        bench_text_entry(screen, max_chars);
+        bench_text_entry_edit(screen, max_chars);
+    }
+#ifdef UI_BENCH_SETTINGS
+    for (size_t npairs : {1, 16, 128}) {
+        bench_bimap_find<uint8_t>("uint8", npairs);
+        bench_bimap_find<uint16_t>("uint16", npairs);
+    }
+    bench_spinners(screen);
+    bench_settings();
+#else
+    printf("settings benchmarks skipped; set PARSON_DIR to build them\n");
+#endif
+    return 0;
+}
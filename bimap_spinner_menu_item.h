@@ -35,10 +35,12 @@
  */
 #pragma once
 #include <type_traits>
-#include <cstdio>
+#include <cassert>
 #include "view.h"
 #include "menu_item.h"
 #include "setting_number.h"
+#include "setting_bimap.h"
+#include "int_format.h"
 #include "mono_graphics_lib.h"
 namespace rppicomidi
 {
@@ -61,71 +63,121 @@ public:
      * @param incr_fn_ The function to increment (or decrement, if the int delta is negative) the currently selected setting value
      * @param context_ A pointer to the class that contains the static get_fn and incr_fn cast to void*
      */
-    Bimap_spinner_menu_item(const char* text_, Mono_graphics& screen_, const Mono_mono_font& font_,
+    Bimap_spinner_menu_item(const Menu_item_text& text_, Mono_graphics& screen_, const Mono_mono_font& font_,
         size_t bimap_idx_, int ndigits_, int nhex_digits_, bool hex_format_,
         T (*get_fn_)(void* context_, size_t bimap_idx, size_t element_idx),
         T (*incr_fn_)(void* context_, size_t bimap_idx, size_t element_idx, int delta), void* context_) :
         Menu_item{text_, screen_, font_},
         bimap_idx{bimap_idx_},
         ndigits{ndigits_}, nhex_digits{nhex_digits_}, hex_format{hex_format_},
-        get_fn{get_fn_}, incr_fn{incr_fn_}, context{context_}
+        get_fn{get_fn_}, incr_fn{incr_fn_}, context{context_}, bimap{nullptr}, dirty_fields{all_fields}
     {
         editing = 2;
         assert(ndigits >= nhex_digits);
+        assert(static_cast<size_t>(ndigits) <= Int_format<T>::max_chars);
     }
 
+    /**
+     * @brief Construct a new Bimap_spinner_menu_item object that edits a
+     * Setting_bimap object directly
+     *
+     * @param text_ The text label for the int spinner value
+     * @param screen_ The screen object that renders this menu item
+     * @param font_  The font to render the label and value
+     * @param bimap_ The Setting_bimap object to edit
+     * @param bimap_idx_ The index in the Setting_bimap object to edit
+     * @param ndigits_ The number of digits of the number field (include space for a sign digit if needed)
+     * @param nhex_digits_ The number of digits of the number field in hex format
+     * @param hex_format_ True to render the int value in hex format; false to render in base 10
+     */
+    Bimap_spinner_menu_item(const Menu_item_text& text_, Mono_graphics& screen_, const Mono_mono_font& font_,
+        Setting_bimap<T>& bimap_, size_t bimap_idx_, int ndigits_, int nhex_digits_, bool hex_format_) :
+        Menu_item{text_, screen_, font_},
+        bimap_idx{bimap_idx_},
+        ndigits{ndigits_}, nhex_digits{nhex_digits_}, hex_format{hex_format_},
+        get_fn{nullptr}, incr_fn{nullptr}, context{nullptr}, bimap{&bimap_}, dirty_fields{all_fields}
+    {
+        editing = 2;
+        assert(ndigits >= nhex_digits);
+        assert(static_cast<size_t>(ndigits) <= Int_format<T>::max_chars);
+    }
+
+    virtual void draw(uint8_t y_)
+    {
+        dirty_fields = all_fields;
+        Menu_item::draw(y_);
+    }
+
+    /**
+     * @brief draw the parts of the item that changed since the last redraw()
+     */
     virtual void redraw()
     {
-        if (is_hidden())
+        if (last_draw_y < 0 || is_hidden())
             return;
-        T first = get_fn(context, bimap_idx, 0);
-        T second = get_fn(context, bimap_idx, 1);
-        T max_val = get_fn(context, bimap_idx, 2) - 1; // The get() method returns the maximum value+1. Display max_val as all asterix
-        char first_str[ndigits+1];
-        char second_str[ndigits+1];
+        T first;
+        T second;
+        T max_val; // Display max_val as all asterix
+        if (bimap) {
+            auto pair = bimap->get_pair(bimap_idx);
+            first = pair.first;
+            second = pair.second;
+            max_val = pair.invalid - 1;
+        }
+        else {
+            first = get_fn(context, bimap_idx, 0);
+            second = get_fn(context, bimap_idx, 1);
+            max_val = get_fn(context, bimap_idx, 2) - 1; // The get() method returns the maximum value+1
+        }
+        char first_str[Int_format<T>::max_chars+1];
+        char second_str[Int_format<T>::max_chars+1];
+        size_t first_len;
+        size_t second_len;
         if (hex_format) {
-            snprintf(first_str, nhex_digits+1, "%0*X", nhex_digits, first);
-            snprintf(second_str, nhex_digits+1, "%0*X", nhex_digits, second);
+            first_len = Int_format<T>::to_hex(first, first_str, nhex_digits);
+            second_len = Int_format<T>::to_hex(second, second_str, nhex_digits);
         }
         else {
-            snprintf(first_str, ndigits+1, "%*d", ndigits, first);
-            snprintf(second_str, ndigits+1, "%-*d", ndigits, second);
+            first_len = Int_format<T>::to_dec(first, first_str, ndigits, false);
+            second_len = Int_format<T>::to_dec(second, second_str, ndigits, true);
         }
-        int disp_digits = hex_format? nhex_digits:ndigits;
+        // keep the fields a fixed width so the "->" does not move
+        size_t disp_digits = hex_format? nhex_digits:ndigits;
+        if (first_len > disp_digits)
+            first_len = disp_digits;
+        if (second_len > disp_digits)
+            second_len = disp_digits;
         if (first == max_val) {
-            for (int idx=0; idx < disp_digits; idx++)
-                first_str[idx]='*';
-            first_str[disp_digits] = '\0';
+            memset(first_str, '*', disp_digits);
+            first_len = disp_digits;
         }
         if (second == max_val) {
-            for (int idx=0; idx < disp_digits; idx++)
-                second_str[idx]='*';
-            second_str[disp_digits] = '\0';
-        }
-        if (is_highlighted() && editing == 2) {
-            // draw the label and both numbers in reverse text
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            screen.draw_string(font, strlen(text)*font.width, last_draw_y, first_str, strlen(first_str), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            screen.draw_string(font, (strlen(text)+strlen(first_str))*font.width, last_draw_y, "->", 2, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            screen.draw_string(font, (strlen(text)+strlen(first_str)+2)*font.width, last_draw_y, second_str, strlen(second_str), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-        }
-        else {
-            // The label text and the "->" are in normal text; the currently editing number is in reverse text
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-            screen.draw_string(font, (strlen(text)+strlen(first_str))*font.width, last_draw_y, "->", 2, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-            if (editing == 0) {
-                screen.draw_string(font, strlen(text)*font.width, last_draw_y, first_str, strlen(first_str), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-                screen.draw_string(font, (strlen(text)+strlen(first_str)+2)*font.width, last_draw_y, second_str, strlen(second_str), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-            }
-            else if (editing == 1) {
-                screen.draw_string(font, strlen(text)*font.width, last_draw_y, first_str, strlen(first_str), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-                screen.draw_string(font, (strlen(text)+strlen(first_str)+2)*font.width, last_draw_y, second_str, strlen(second_str), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            }
-            else {
-                screen.draw_string(font, strlen(text)*font.width, last_draw_y, first_str, strlen(first_str), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-                screen.draw_string(font, (strlen(text)+strlen(first_str)+2)*font.width, last_draw_y, second_str, strlen(second_str), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-            }
+            memset(second_str, '*', disp_digits);
+            second_len = disp_digits;
         }
+        uint8_t first_x = text_len*font.width;
+        uint8_t arrow_x = first_x + first_len*font.width;
+        uint8_t second_x = arrow_x + 2*font.width;
+        // If highlighted and not editing, draw the label and both numbers in reverse text.
+        // Otherwise, the label text and the "->" are in normal text and the currently
+        // editing number is in reverse text
+        bool reverse_all = is_highlighted() && editing == 2;
+        if (dirty_fields & label_field)
+            draw_field(0, text, text_len, reverse_all);
+        if (dirty_fields & first_field)
+            draw_field(first_x, first_str, first_len, reverse_all || editing == 0);
+        if (dirty_fields & arrow_field)
+            draw_field(arrow_x, "->", 2, reverse_all);
+        if (dirty_fields & second_field)
+            draw_field(second_x, second_str, second_len, reverse_all || editing == 1);
+        dirty_fields = 0;
+    }
+
+    virtual void set_highlighted(bool highlighted_)
+    {
+        if (highlighted_ != highlighted)
+            dirty_fields = all_fields;
+        Menu_item::set_highlighted(highlighted_);
     }
 
     void entry() final
@@ -137,6 +189,7 @@ public:
     {
         editing = 2;
         last_draw_y=-1;
+        dirty_fields = all_fields;
     }
 
     void on_increment(uint32_t delta, bool is_shifted) final
@@ -157,16 +210,21 @@ public:
 
     virtual void on_left(uint32_t, bool)
     {
-        if (editing == 1)
+        if (editing == 1) {
+            // only the highlight of the two numbers changes
             editing = 0;
-        redraw();
+            dirty_fields |= first_field | second_field;
+            invalidate();
+        }
     }
 
     virtual void on_right(uint32_t, bool)
     {
-        if (editing == 0)
+        if (editing == 0) {
             editing = 1;
-        redraw();
+            dirty_fields |= first_field | second_field;
+            invalidate();
+        }
     }
 
     virtual View::Select_result on_select(View**)
@@ -177,7 +235,8 @@ public:
         else {
             editing = 0;
         }
-        redraw();
+        dirty_fields = all_fields;
+        invalidate();
         if (editing != 2)
             return View::Select_result::take_focus;
         return View::Select_result::give_focus;
@@ -185,16 +244,42 @@ public:
 
     virtual size_t get_bimap_idx() const { return bimap_idx; }
 
-    void set_display_hex(bool is_hex) { hex_format = is_hex; }
+    void set_display_hex(bool is_hex) { hex_format = is_hex; dirty_fields = all_fields; }
 protected:
+    /// the parts of the item redraw() has to draw
+    enum Field {
+        label_field = 1,
+        first_field = 2,
+        arrow_field = 4,
+        second_field = 8,
+        all_fields = label_field | first_field | arrow_field | second_field,
+    };
+
+    void draw_field(uint8_t x, const char* str, size_t len, bool reverse)
+    {
+        screen.draw_string(font, x, last_draw_y, str, len,
+            reverse ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE,
+            reverse ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO);
+    }
+
     void incr(int delta)
     {
         if (editing == 2)
             return;
-        T oldval = get_fn(context, bimap_idx, editing);
-        T newval = incr_fn(context, bimap_idx, editing, delta);
-        if (oldval != newval)
-            redraw();
+        T oldval;
+        T newval;
+        if (bimap) {
+            oldval = bimap->get(bimap_idx, editing);
+            newval = bimap->incr(bimap_idx, editing, delta);
+        }
+        else {
+            oldval = get_fn(context, bimap_idx, editing);
+            newval = incr_fn(context, bimap_idx, editing, delta);
+        }
+        if (oldval != newval) {
+            dirty_fields |= (editing == 0) ? first_field : second_field;
+            invalidate();
+        }
     }
     size_t bimap_idx;
     int ndigits;
@@ -203,6 +288,8 @@ protected:
     T (*get_fn)(void* context_, size_t bimap_idx, size_t element_idx);
     T (*incr_fn)(void* context_, size_t bimap_idx, size_t element_idx, int delta);
     void* context;
+    Setting_bimap<T>* bimap;  //!< if not nullptr, the setting to edit instead of calling get_fn and incr_fn
     size_t editing;       //<! 0 if editing the first value, 1 if editing the second value, 2 if not editing
+    uint8_t dirty_fields; //!< the Field bits for the parts that changed since the last redraw()
 };
 }
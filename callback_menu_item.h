@@ -46,7 +46,7 @@ public:
      * and the second argument is a pointer to the new view if the select_action is new_view
      * @param select_action_ the default select action for this object
      */
-    Callback_menu_item(const char* text_, Mono_graphics& screen_, const Mono_mono_font& font_, View* callback_view_, void (*callback_)(View*, View**),
+    Callback_menu_item(const Menu_item_text& text_, Mono_graphics& screen_, const Mono_mono_font& font_, View* callback_view_, void (*callback_)(View*, View**),
     View::Select_result select_action_=View::Select_result::no_op)  :
         Menu_item{text_, screen_, font_}, callback_view{callback_view_}, callback{callback_}, select_action{select_action_} {}
 
@@ -0,0 +1,136 @@
+/**
+ * @file frame_handoff.h
+ * @brief these classes describe a double buffer that passes completed screen
+ * frames from the core that draws them to the core or thread that
+ * sends them to the display.
+ *
+ * For example, core0 handles MIDI and UI input and draws with
+ * View_manager::render(), and core1 runs a loop that calls acquire(),
+ * sends the frame to the display, and then calls release(). Sending
+ * a frame over I2C takes a long time, so this keeps the input and
+ * MIDI code from waiting on the display.
+ *
+ * The producer and the consumer only use atomic loads and stores to
+ * coordinate, so the code works on the Cortex-M0+ and on a Linux host
+ * where a std::thread stands in for the second core. Neither side
+ * ever blocks. If the consumer is still reading the buffer the
+ * producer wants to write, publish() returns false and the producer
+ * tries again later.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+namespace rppicomidi
+{
+class Frame_handoff_base
+{
+public:
+    Frame_handoff_base(uint8_t* buffer0_, uint8_t* buffer1_, size_t frame_size_) :
+        frame_size{frame_size_}, ready{-1}, reading{-1}, published_count{0}, acquired_count{0}
+    {
+        buffers[0] = buffer0_;
+        buffers[1] = buffer1_;
+    }
+    Frame_handoff_base(const Frame_handoff_base&) = delete;
+    Frame_handoff_base& operator=(const Frame_handoff_base&) = delete;
+    virtual ~Frame_handoff_base() = default;
+
+    /**
+     * @brief copy a completed frame to the buffer the consumer is not
+     * using and make it the newest frame; only call from the producer
+     *
+     * @param frame the frame_size bytes of frame data
+     * @return false if the consumer is still reading the buffer this
+     * function would overwrite. Call publish() again later.
+     */
+    bool publish(const uint8_t* frame)
+    {
+        int8_t back = ready.load() == 0 ? 1 : 0;
+        if (reading.load() == back)
+            return false;
+        memcpy(buffers[back], frame, frame_size);
+        ready.store(back);
+        published_count.store(published_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief get the newest frame if publish() was called since the last
+     * call to acquire(); only call from the consumer
+     *
+     * @param frame set to point to the newest frame. The frame data stays
+     * valid until the consumer calls release().
+     * @return true if there is a new frame, false otherwise
+     */
+    bool acquire(const uint8_t** frame)
+    {
+        uint32_t count = published_count.load(std::memory_order_acquire);
+        if (count == acquired_count)
+            return false;
+        int8_t front;
+        do {
+            // announce which buffer is being read, and then make sure the
+            // producer did not start writing to it before it saw the announcement
+            front = ready.load();
+            reading.store(front);
+        } while (ready.load() != front);
+        acquired_count = count;
+        *frame = buffers[front];
+        return true;
+    }
+
+    /**
+     * @brief tell the producer the consumer is done with the frame the
+     * last call to acquire() returned; only call from the consumer
+     */
+    void release() { reading.store(-1); }
+
+    size_t get_frame_size() const { return frame_size; }
+private:
+    uint8_t* buffers[2];
+    const size_t frame_size;
+    std::atomic<int8_t> ready;      //!< the buffer that holds the newest frame or -1; only the producer writes it
+    std::atomic<int8_t> reading;    //!< the buffer the consumer is reading or -1; only the consumer writes it
+    std::atomic<uint32_t> published_count; //!< only the producer writes it
+    uint32_t acquired_count;        //!< the value of published_count the last time acquire() returned true
+};
+
+/**
+ * @brief a Frame_handoff_base that holds both frame buffers
+ *
+ * @tparam frame_size_ the number of bytes in a frame; for example,
+ * 1024 for a 128x64 monochrome display
+ */
+template<size_t frame_size_>
+class Frame_handoff : public Frame_handoff_base
+{
+public:
+    Frame_handoff() : Frame_handoff_base{storage[0], storage[1], frame_size_} {}
+private:
+    uint8_t storage[2][frame_size_];
+};
+}
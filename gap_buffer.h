@@ -0,0 +1,186 @@
+/**
+ * @file gap_buffer.h
+ * @brief a fixed capacity text buffer for a text editor.
+ *
+ * The text is stored in one array with a gap of unused characters
+ * at the edit position. Inserting or deleting a character next to
+ * the gap only moves the end of the gap, so typing at the cursor takes
+ * constant time and never allocates memory. Moving the edit position
+ * moves the characters between the old and new position across the gap.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+namespace rppicomidi
+{
+class Gap_buffer
+{
+public:
+    Gap_buffer() = delete;
+    Gap_buffer(const Gap_buffer&) = delete;
+    Gap_buffer& operator=(const Gap_buffer&) = delete;
+
+    /**
+     * @brief Construct a new Gap_buffer object
+     *
+     * @param capacity_ the maximum number of characters the buffer holds
+     */
+    Gap_buffer(size_t capacity_) : buffer{new char[capacity_+1]}, capacity{capacity_},
+        gap_start{0}, gap_end{capacity_}
+    {
+        buffer[capacity] = '\0';
+    }
+
+    ~Gap_buffer() { delete[] buffer; }
+
+    /**
+     * @brief Get the number of characters in the buffer
+     */
+    size_t size() const { return capacity - (gap_end - gap_start); }
+
+    /**
+     * @brief Get the maximum number of characters the buffer can hold
+     */
+    size_t get_capacity() const { return capacity; }
+
+    /**
+     * @brief Get the character at position pos
+     *
+     * @param pos the character position from 0 to size()-1
+     */
+    char at(size_t pos) const
+    {
+        assert(pos < size());
+        return pos < gap_start ? buffer[pos] : buffer[pos + (gap_end - gap_start)];
+    }
+
+    /**
+     * @brief insert ch before position pos
+     *
+     * @param pos the insert position from 0 to size()
+     * @param ch the character to insert
+     * @return false if the buffer is full or pos is out of range
+     */
+    bool insert(size_t pos, char ch)
+    {
+        if (gap_start == gap_end || pos > size())
+            return false;
+        move_gap(pos);
+        buffer[gap_start++] = ch;
+        return true;
+    }
+
+    /**
+     * @brief delete the character at position pos
+     *
+     * @param pos the character position from 0 to size()-1
+     * @return false if pos is out of range
+     */
+    bool erase(size_t pos)
+    {
+        if (pos >= size())
+            return false;
+        move_gap(pos);
+        ++gap_end;
+        return true;
+    }
+
+    /**
+     * @brief replace the character at position pos with ch
+     *
+     * @param pos the character position from 0 to size()-1
+     * @param ch the new character
+     * @return false if pos is out of range
+     */
+    bool replace(size_t pos, char ch)
+    {
+        if (pos >= size())
+            return false;
+        if (pos < gap_start)
+            buffer[pos] = ch;
+        else
+            buffer[pos + (gap_end - gap_start)] = ch;
+        return true;
+    }
+
+    /**
+     * @brief replace the contents of the buffer with the first
+     * get_capacity() characters of str
+     */
+    void assign(const char* str)
+    {
+        size_t len = 0;
+        while (len < capacity && str[len] != '\0') {
+            buffer[len] = str[len];
+            ++len;
+        }
+        gap_start = len;
+        gap_end = capacity;
+    }
+
+    /**
+     * @brief delete all characters
+     */
+    void clear() { gap_start = 0; gap_end = capacity; }
+
+    /**
+     * @brief Get the contents of the buffer as a '\0' terminated string.
+     *
+     * This function moves the gap to the end of the text, so it takes
+     * time proportional to the number of characters after the gap.
+     * The pointer is valid until the buffer is changed.
+     */
+    const char* c_str()
+    {
+        move_gap(size());
+        buffer[gap_start] = '\0';
+        return buffer;
+    }
+private:
+    /**
+     * @brief move the gap so that it starts at position pos
+     */
+    void move_gap(size_t pos)
+    {
+        if (pos < gap_start) {
+            size_t nmove = gap_start - pos;
+            memmove(buffer + gap_end - nmove, buffer + pos, nmove);
+            gap_start -= nmove;
+            gap_end -= nmove;
+        }
+        else if (pos > gap_start) {
+            size_t nmove = pos - gap_start;
+            memmove(buffer + gap_start, buffer + gap_end, nmove);
+            gap_start += nmove;
+            gap_end += nmove;
+        }
+    }
+    char* buffer;       //!< capacity+1 characters, so c_str() always has room for the '\0'
+    size_t capacity;
+    size_t gap_start;   //!< the position of the first unused character
+    size_t gap_end;     //!< the position of the first character after the gap
+};
+}
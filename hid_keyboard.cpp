@@ -117,30 +117,30 @@ void rppicomidi::Hid_keyboard::process_kbd_report(hid_keyboard_report_t const *r
                 bool const is_shift = report->modifier & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT);
                 switch (report->keycode[idx]) {
                 case HID_KEY_ARROW_RIGHT:
-                    vm->on_right(1, is_shift);
+                    vm->post_event(Ui_event{Ui_event::right, 1, is_shift}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_ARROW_LEFT:
-                    vm->on_left(1, is_shift);
+                    vm->post_event(Ui_event{Ui_event::left, 1, is_shift}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_ARROW_UP:
-                    vm->on_increment(1, is_shift);
+                    vm->post_event(Ui_event{Ui_event::increment, 1, is_shift}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_ARROW_DOWN:
-                    vm->on_decrement(1, is_shift);
+                    vm->post_event(Ui_event{Ui_event::decrement, 1, is_shift}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_HOME:
-                    vm->go_home();
+                    vm->post_event(Ui_event{Ui_event::home}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_ESCAPE:
-                    vm->on_back();
+                    vm->post_event(Ui_event{Ui_event::back}, View_manager::keyboard_input);
                     break;
                 case HID_KEY_ENTER:
                 case HID_KEY_KEYPAD_ENTER:
-                    vm->on_select();
+                    vm->post_event(Ui_event{Ui_event::select}, View_manager::keyboard_input);
                     break;
                 // TODO handle num lock and caps lock
                 default:
-                    vm->on_key(report->keycode[idx], report->modifier, true);
+                    vm->post_event(Ui_event{report->keycode[idx], report->modifier, true}, View_manager::keyboard_input);
                     break;
                 }
             }
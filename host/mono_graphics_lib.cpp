@@ -0,0 +1,276 @@
+/**
+ * @file host/mono_graphics_lib.cpp
+ * @brief this file implements the host (Linux) stand-in for the Mono_graphics class
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include "mono_graphics_lib.h"
+
+// Column-major 5x7 glyphs for ASCII 0x20 through 0x7E; bit 0 is the top pixel
+static const uint8_t glyph_width = 5;
+static const uint8_t glyph_height = 8;
+static const char first_glyph = ' ';
+static const char last_glyph = '~';
+static const uint8_t glyphs[last_glyph - first_glyph + 1][glyph_width] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // '!'
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // '"'
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // '#'
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // '$'
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // '%'
+    {0x36, 0x49, 0x56, 0x20, 0x50}, // '&'
+    {0x00, 0x08, 0x07, 0x03, 0x00}, // '''
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // '('
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // ')'
+    {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, // '*'
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // '+'
+    {0x00, 0x80, 0x70, 0x30, 0x00}, // ','
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // '-'
+    {0x00, 0x00, 0x60, 0x60, 0x00}, // '.'
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // '/'
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // '0'
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // '1'
+    {0x72, 0x49, 0x49, 0x49, 0x46}, // '2'
+    {0x21, 0x41, 0x49, 0x4D, 0x33}, // '3'
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // '4'
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // '5'
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, // '6'
+    {0x41, 0x21, 0x11, 0x09, 0x07}, // '7'
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // '8'
+    {0x46, 0x49, 0x49, 0x29, 0x1E}, // '9'
+    {0x00, 0x00, 0x14, 0x00, 0x00}, // ':'
+    {0x00, 0x40, 0x34, 0x00, 0x00}, // ';'
+    {0x00, 0x08, 0x14, 0x22, 0x41}, // '<'
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // '='
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // '>'
+    {0x02, 0x01, 0x59, 0x09, 0x06}, // '?'
+    {0x3E, 0x41, 0x5D, 0x59, 0x4E}, // '@'
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, // 'A'
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // 'B'
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // 'C'
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, // 'D'
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // 'E'
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // 'F'
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, // 'G'
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // 'H'
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // 'I'
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // 'J'
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // 'K'
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // 'L'
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, // 'M'
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // 'N'
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // 'O'
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // 'P'
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // 'Q'
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // 'R'
+    {0x26, 0x49, 0x49, 0x49, 0x32}, // 'S'
+    {0x03, 0x01, 0x7F, 0x01, 0x03}, // 'T'
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // 'U'
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // 'V'
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // 'W'
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // 'X'
+    {0x03, 0x04, 0x78, 0x04, 0x03}, // 'Y'
+    {0x61, 0x59, 0x49, 0x4D, 0x43}, // 'Z'
+    {0x00, 0x7F, 0x41, 0x41, 0x41}, // '['
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
+    {0x00, 0x41, 0x41, 0x41, 0x7F}, // ']'
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // '^'
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // '_'
+    {0x00, 0x03, 0x07, 0x08, 0x00}, // '`'
+    {0x20, 0x54, 0x54, 0x78, 0x40}, // 'a'
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, // 'b'
+    {0x38, 0x44, 0x44, 0x44, 0x28}, // 'c'
+    {0x38, 0x44, 0x44, 0x28, 0x7F}, // 'd'
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // 'e'
+    {0x00, 0x08, 0x7E, 0x09, 0x02}, // 'f'
+    {0x18, 0xA4, 0xA4, 0x9C, 0x78}, // 'g'
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // 'h'
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // 'i'
+    {0x20, 0x40, 0x40, 0x3D, 0x00}, // 'j'
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // 'k'
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // 'l'
+    {0x7C, 0x04, 0x78, 0x04, 0x78}, // 'm'
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // 'n'
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // 'o'
+    {0xFC, 0x18, 0x24, 0x24, 0x18}, // 'p'
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, // 'q'
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // 'r'
+    {0x48, 0x54, 0x54, 0x54, 0x24}, // 's'
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, // 't'
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // 'u'
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // 'v'
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // 'w'
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // 'x'
+    {0x4C, 0x90, 0x90, 0x90, 0x7C}, // 'y'
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // 'z'
+    {0x00, 0x08, 0x36, 0x41, 0x00}, // '{'
+    {0x00, 0x00, 0x77, 0x00, 0x00}, // '|'
+    {0x00, 0x41, 0x36, 0x08, 0x00}, // '}'
+    {0x02, 0x01, 0x02, 0x04, 0x02}, // '~'
+};
+
+rppicomidi::Mono_graphics::Mono_graphics() :
+    clip_rect{0, 0, screen_width, screen_height},
+    font_8{6, 8, 1}, font_12{8, 12, 1}, font_16{12, 16, 2},
+    num_pixels_drawn{0}
+{
+    clear_canvas();
+}
+
+void rppicomidi::Mono_graphics::clear_canvas()
+{
+    memset(canvas, 0, sizeof(canvas));
+}
+
+void rppicomidi::Mono_graphics::draw_pixel(int x, int y, Pixel_state pixel_state)
+{
+    if (x < 0 || y < 0 || x >= screen_width || y >= screen_height)
+        return;
+    uint8_t& page_byte = canvas[x + screen_width * (y / 8)];
+    uint8_t mask = 1 << (y % 8);
+    switch (pixel_state) {
+    case Pixel_state::PIXEL_ZERO:
+        page_byte &= ~mask;
+        break;
+    case Pixel_state::PIXEL_ONE:
+        page_byte |= mask;
+        break;
+    case Pixel_state::PIXEL_XOR:
+        page_byte ^= mask;
+        break;
+    }
+    ++num_pixels_drawn;
+}
+
+bool rppicomidi::Mono_graphics::get_pixel(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= screen_width || y >= screen_height)
+        return false;
+    return (canvas[x + screen_width * (y / 8)] & (1 << (y % 8))) != 0;
+}
+
+void rppicomidi::Mono_graphics::draw_rectangle(const Rectangle& rect, Pixel_state line_color, Pixel_state fill_color)
+{
+    draw_rectangle(rect.x_upper_left, rect.y_upper_left, rect.width, rect.height, line_color, fill_color);
+}
+
+void rppicomidi::Mono_graphics::draw_rectangle(uint8_t x, uint8_t y, uint8_t width, uint8_t height, Pixel_state line_color, Pixel_state fill_color)
+{
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            bool is_line = row == 0 || col == 0 || row == height - 1 || col == width - 1;
+            draw_pixel(x + col, y + row, is_line ? line_color : fill_color);
+        }
+    }
+}
+
+void rppicomidi::Mono_graphics::draw_character(const Mono_mono_font& font, uint8_t x, uint8_t y, char ch, Pixel_state fg_color, Pixel_state bg_color)
+{
+    if (ch < first_glyph || ch > last_glyph)
+        ch = '?';
+    const uint8_t* glyph = glyphs[ch - first_glyph];
+    for (int row = 0; row < font.height; row++) {
+        int glyph_row = row / font.scale;
+        for (int col = 0; col < font.width; col++) {
+            int glyph_col = col / font.scale;
+            bool is_fg = glyph_col < glyph_width && glyph_row < glyph_height && (glyph[glyph_col] & (1 << glyph_row)) != 0;
+            draw_pixel(x + col, y + row, is_fg ? fg_color : bg_color);
+        }
+    }
+}
+
+void rppicomidi::Mono_graphics::draw_string(const Mono_mono_font& font, uint8_t x, uint8_t y, const char* str, size_t nchar, Pixel_state fg_color, Pixel_state bg_color)
+{
+    for (size_t idx = 0; idx < nchar && str[idx] != '\0'; idx++) {
+        int char_x = x + static_cast<int>(idx) * font.width;
+        if (char_x >= screen_width)
+            break;
+        draw_character(font, static_cast<uint8_t>(char_x), y, str[idx], fg_color, bg_color);
+    }
+}
+
+void rppicomidi::Mono_graphics::center_string(const Mono_mono_font& font, const char* str, uint8_t y)
+{
+    size_t nchar = strlen(str);
+    int x = (screen_width - static_cast<int>(nchar) * font.width) / 2;
+    if (x < 0)
+        x = 0;
+    draw_string(font, static_cast<uint8_t>(x), y, str, nchar, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+}
+
+void rppicomidi::Mono_graphics::capture_bitmap(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* bitmap) const
+{
+    const uint8_t npages = (height + 7) / 8;
+    const uint32_t column_mask = (1ul << height) - 1;
+    for (uint8_t col = 0; col < width; col++) {
+        uint32_t column = 0;
+        if (x + col < screen_width) {
+            // gather the canvas pages the rectangle covers, then shift the top row to bit 0
+            for (int page = y / 8, shift = 0; page < screen_height / 8 && shift < 32; page++, shift += 8)
+                column |= static_cast<uint32_t>(canvas[x + col + screen_width * page]) << shift;
+            column = (column >> (y % 8)) & column_mask;
+        }
+        for (uint8_t page = 0; page < npages; page++)
+            bitmap[col + width * page] = static_cast<uint8_t>(column >> (8 * page));
+    }
+}
+
+void rppicomidi::Mono_graphics::draw_bitmap(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t* bitmap, bool invert)
+{
+    const uint8_t npages = (height + 7) / 8;
+    const uint32_t column_mask = (1ul << height) - 1;
+    for (uint8_t col = 0; col < width && x + col < screen_width; col++) {
+        uint32_t column = 0;
+        for (uint8_t page = 0; page < npages; page++)
+            column |= static_cast<uint32_t>(bitmap[col + width * page]) << (8 * page);
+        if (invert)
+            column = ~column;
+        // line up the bitmap rows with the canvas pages
+        uint32_t mask = column_mask << (y % 8);
+        column = (column & column_mask) << (y % 8);
+        for (int page = y / 8; mask != 0 && page < screen_height / 8; page++, mask >>= 8, column >>= 8) {
+            uint8_t& page_byte = canvas[x + col + screen_width * page];
+            page_byte = (page_byte & ~static_cast<uint8_t>(mask)) | static_cast<uint8_t>(column & mask);
+        }
+    }
+    num_pixels_drawn += static_cast<uint32_t>(width) * height;
+}
+
+bool rppicomidi::Mono_graphics::save_pbm(const char* filename) const
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == nullptr)
+        return false;
+    fprintf(fp, "P4\n%u %u\n", screen_width, screen_height);
+    for (int y = 0; y < screen_height; y++) {
+        uint8_t row[screen_width / 8];
+        memset(row, 0, sizeof(row));
+        for (int x = 0; x < screen_width; x++) {
+            if (get_pixel(x, y))
+                row[x / 8] |= 0x80 >> (x % 8);
+        }
+        fwrite(row, 1, sizeof(row), fp);
+    }
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file host/mono_graphics_lib.h
+ * @brief this class describes a host (Linux) stand-in for the Mono_graphics
+ * class of the pico-ssd1306-mono-graphics-lib project.
+ *
+ * It draws into an in-memory 128x64 canvas that uses the same page layout
+ * as the SSD1306 display RAM: byte x + 128 * (y / 8) holds the pixels
+ * in column x from row 8 * (y / 8) to row 8 * (y / 8) + 7, with the
+ * top pixel in bit 0. The fonts use a 5x7 ASCII glyph set padded to the
+ * font's character cell size, so the frames are readable but not
+ * pixel-identical to the target. Only the drawing functions this
+ * library uses are implemented.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+// This Mono_graphics class has capture_bitmap() and draw_bitmap()
+#define MONO_GRAPHICS_HAS_BITMAP_COPY 1
+namespace rppicomidi
+{
+enum class Pixel_state {PIXEL_ZERO, PIXEL_ONE, PIXEL_XOR};
+
+struct Rectangle {
+    uint8_t x_upper_left;
+    uint8_t y_upper_left;
+    uint8_t width;
+    uint8_t height;
+};
+
+struct Mono_mono_font {
+    uint8_t width;      //!< the width of a character cell in pixels
+    uint8_t height;     //!< the height of a character cell in pixels
+    uint8_t scale;      //!< the number of pixels per glyph pixel
+};
+
+class Mono_graphics
+{
+public:
+    Mono_graphics();
+
+    void clear_canvas();
+
+    /**
+     * @brief set the pixel at x, y; pixels off the canvas are ignored
+     */
+    void draw_pixel(int x, int y, Pixel_state pixel_state);
+
+    void draw_rectangle(const Rectangle& rect, Pixel_state line_color, Pixel_state fill_color);
+    void draw_rectangle(uint8_t x, uint8_t y, uint8_t width, uint8_t height, Pixel_state line_color, Pixel_state fill_color);
+    void draw_character(const Mono_mono_font& font, uint8_t x, uint8_t y, char ch, Pixel_state fg_color, Pixel_state bg_color);
+    void draw_string(const Mono_mono_font& font, uint8_t x, uint8_t y, const char* str, size_t nchar, Pixel_state fg_color, Pixel_state bg_color);
+
+    /**
+     * @brief draw str centered horizontally on the screen with the top of the
+     * string y pixels from the top of the screen
+     */
+    void center_string(const Mono_mono_font& font, const char* str, uint8_t y);
+
+    /**
+     * @brief copy a rectangle of the canvas to a bitmap
+     *
+     * The bitmap has the same layout as the canvas: (height+7)/8 pages of
+     * width bytes, with bit n of a byte for row n of the page. Pixels off
+     * the canvas are copied as off.
+     *
+     * @param x the left edge of the rectangle
+     * @param y the top edge of the rectangle
+     * @param width the width of the rectangle in pixels
+     * @param height the height of the rectangle in pixels; 24 at most
+     * @param bitmap storage for width*((height+7)/8) bytes
+     */
+    void capture_bitmap(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t* bitmap) const;
+
+    /**
+     * @brief draw a bitmap capture_bitmap() made
+     *
+     * Copying whole columns of pixels is much faster than drawing the
+     * glyphs of a string again.
+     *
+     * @param x the left edge of where to draw the bitmap
+     * @param y the top edge of where to draw the bitmap
+     * @param width the width of the bitmap in pixels
+     * @param height the height of the bitmap in pixels; 24 at most
+     * @param bitmap the bitmap
+     * @param invert true to draw the pixels that are off in the bitmap and
+     * to erase the pixels that are on
+     */
+    void draw_bitmap(uint8_t x, uint8_t y, uint8_t width, uint8_t height, const uint8_t* bitmap, bool invert);
+
+    uint8_t get_screen_width() const { return screen_width; }
+    uint8_t get_screen_height() const { return screen_height; }
+    const Rectangle& get_clip_rect() const { return clip_rect; }
+    const Mono_mono_font& get_font_8() const { return font_8; }
+    const Mono_mono_font& get_font_12() const { return font_12; }
+    const Mono_mono_font& get_font_16() const { return font_16; }
+
+    // The rest of the functions are for host tests and benchmarks only
+
+    /**
+     * @brief get the canvas in SSD1306 page layout; get_canvas_size() bytes long
+     */
+    const uint8_t* get_canvas() const { return canvas; }
+    size_t get_canvas_size() const { return sizeof(canvas); }
+
+    /**
+     * @brief get the state of the pixel at x, y
+     *
+     * @return true if the pixel is on, false if it is off or off the canvas
+     */
+    bool get_pixel(int x, int y) const;
+
+    /**
+     * @brief write the canvas to a binary (P4) PBM file; pixels that are on
+     * are black
+     *
+     * @param filename the name of the file to create or overwrite
+     * @return true if successful, false otherwise
+     */
+    bool save_pbm(const char* filename) const;
+
+    /**
+     * @brief get the number of pixels drawn since the last
+     * call to reset_num_pixels_drawn()
+     */
+    uint32_t get_num_pixels_drawn() const { return num_pixels_drawn; }
+    void reset_num_pixels_drawn() { num_pixels_drawn = 0; }
+private:
+    static const uint8_t screen_width = 128;
+    static const uint8_t screen_height = 64;
+    uint8_t canvas[screen_width * screen_height / 8];
+    const Rectangle clip_rect;
+    const Mono_mono_font font_8;
+    const Mono_mono_font font_12;
+    const Mono_mono_font font_16;
+    uint32_t num_pixels_drawn;
+};
+}
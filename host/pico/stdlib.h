@@ -0,0 +1,76 @@
+/**
+ * @file host/pico/stdlib.h
+ * @brief this file declares host (Linux) stand-ins for the parts of the Pico C SDK
+ * this library uses: the time functions and the GPIO input functions.
+ *
+ * Time comes from the host's monotonic clock unless a test calls
+ * host_set_time_us() to control it. The GPIO inputs read back whatever
+ * host_gpio_put() or host_gpio_put_all() last set, so tests can simulate
+ * button presses; all inputs start high as if pulled up.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time();
+static inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return static_cast<uint32_t>(t / 1000); }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to)
+{
+    return static_cast<int64_t>(to - from);
+}
+static inline uint64_t time_us_64() { return to_us_since_boot(get_absolute_time()); }
+static inline uint32_t time_us_32() { return static_cast<uint32_t>(time_us_64()); }
+void sleep_us(uint64_t us);
+static inline void sleep_ms(uint32_t ms) { sleep_us(static_cast<uint64_t>(ms) * 1000); }
+
+#define GPIO_IN false
+#define GPIO_OUT true
+void gpio_init(unsigned gpio);
+void gpio_set_dir(unsigned gpio, bool out);
+void gpio_pull_up(unsigned gpio);
+bool gpio_get(unsigned gpio);
+uint32_t gpio_get_all();
+
+// The rest of the functions are for host tests only
+
+/**
+ * @brief make get_absolute_time() return now_us until the next call;
+ * sleep_us() then advances the time instead of sleeping
+ */
+void host_set_time_us(uint64_t now_us);
+
+/**
+ * @brief set the level that gpio_get() and gpio_get_all() return for gpio
+ */
+void host_gpio_put(unsigned gpio, bool value);
+
+/**
+ * @brief set the level of all GPIO inputs; bit n is the level of GPIO n
+ */
+void host_gpio_put_all(uint32_t values);
@@ -0,0 +1,100 @@
+/**
+ * @file host/pico_stdlib.cpp
+ * @brief this file implements the host (Linux) stand-ins for the Pico C SDK functions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <chrono>
+#include <thread>
+#include "pico/stdlib.h"
+
+static bool manual_time = false;
+static uint64_t manual_time_us = 0;
+static uint32_t gpio_levels = 0xffffffff;
+
+absolute_time_t get_absolute_time()
+{
+    if (manual_time)
+        return manual_time_us;
+    static const auto boot = std::chrono::steady_clock::now();
+    auto since_boot = std::chrono::steady_clock::now() - boot;
+    return static_cast<absolute_time_t>(std::chrono::duration_cast<std::chrono::microseconds>(since_boot).count());
+}
+
+void sleep_us(uint64_t us)
+{
+    if (manual_time)
+        manual_time_us += us;
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void host_set_time_us(uint64_t now_us)
+{
+    manual_time = true;
+    manual_time_us = now_us;
+}
+
+void gpio_init(unsigned gpio)
+{
+    assert(gpio < 32);
+    (void)gpio;
+}
+
+void gpio_set_dir(unsigned gpio, bool out)
+{
+    assert(gpio < 32);
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_pull_up(unsigned gpio)
+{
+    assert(gpio < 32);
+    (void)gpio;
+}
+
+bool gpio_get(unsigned gpio)
+{
+    assert(gpio < 32);
+    return (gpio_levels & (1u << gpio)) != 0;
+}
+
+uint32_t gpio_get_all()
+{
+    return gpio_levels;
+}
+
+void host_gpio_put(unsigned gpio, bool value)
+{
+    assert(gpio < 32);
+    if (value)
+        gpio_levels |= (1u << gpio);
+    else
+        gpio_levels &= ~(1u << gpio);
+}
+
+void host_gpio_put_all(uint32_t values)
+{
+    gpio_levels = values;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file host/tusb.cpp
+ * @brief this file implements the host (Linux) stand-ins for the TinyUSB host HID functions
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "tusb.h"
+
+static uint8_t interface_protocol = HID_ITF_PROTOCOL_KEYBOARD;
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t instance)
+{
+    (void)dev_addr;
+    (void)instance;
+    return interface_protocol;
+}
+
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t* report_info_arr, uint8_t arr_count, uint8_t const* desc_report, uint16_t desc_len)
+{
+    (void)desc_report;
+    (void)desc_len;
+    // assume a simple boot keyboard report without a report ID
+    if (arr_count == 0)
+        return 0;
+    report_info_arr[0].report_id = 0;
+    report_info_arr[0].usage = HID_USAGE_DESKTOP_KEYBOARD;
+    report_info_arr[0].usage_page = HID_USAGE_PAGE_DESKTOP;
+    return 1;
+}
+
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t instance)
+{
+    (void)dev_addr;
+    (void)instance;
+    return true;
+}
+
+void host_tuh_hid_set_interface_protocol(uint8_t protocol)
+{
+    interface_protocol = protocol;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file host/tusb.h
+ * @brief this file is a host (Linux) stand-in for the parts of the TinyUSB
+ * host HID API that this library uses. The constants match TinyUSB's
+ * class/hid/hid.h. The tuh_hid_*() functions report that no device is
+ * attached, so tests must feed Hid_keyboard reports through
+ * Hid_keyboard::tuh_hid_report_received_cb() or post events to the
+ * View_manager directly.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#ifndef CFG_TUH_HID
+#define CFG_TUH_HID 4
+#endif
+
+#define TU_LOG1(...) do {} while (0)
+#define TU_LOG2(...) do {} while (0)
+
+typedef struct {
+    uint8_t modifier;
+    uint8_t reserved;
+    uint8_t keycode[6];
+} hid_keyboard_report_t;
+
+typedef struct {
+    uint8_t report_id;
+    uint8_t usage;
+    uint16_t usage_page;
+} tuh_hid_report_info_t;
+
+enum {
+    HID_ITF_PROTOCOL_NONE = 0,
+    HID_ITF_PROTOCOL_KEYBOARD = 1,
+    HID_ITF_PROTOCOL_MOUSE = 2,
+};
+
+enum {
+    HID_USAGE_PAGE_DESKTOP = 0x01,
+};
+
+enum {
+    HID_USAGE_DESKTOP_KEYBOARD = 0x06,
+};
+
+enum {
+    KEYBOARD_MODIFIER_LEFTCTRL = 0x01,
+    KEYBOARD_MODIFIER_LEFTSHIFT = 0x02,
+    KEYBOARD_MODIFIER_LEFTALT = 0x04,
+    KEYBOARD_MODIFIER_LEFTGUI = 0x08,
+    KEYBOARD_MODIFIER_RIGHTCTRL = 0x10,
+    KEYBOARD_MODIFIER_RIGHTSHIFT = 0x20,
+    KEYBOARD_MODIFIER_RIGHTALT = 0x40,
+    KEYBOARD_MODIFIER_RIGHTGUI = 0x80,
+};
+
+#define HID_KEY_A             0x04
+#define HID_KEY_Z             0x1D
+#define HID_KEY_1             0x1E
+#define HID_KEY_0             0x27
+#define HID_KEY_ENTER         0x28
+#define HID_KEY_ESCAPE        0x29
+#define HID_KEY_BACKSPACE     0x2A
+#define HID_KEY_TAB           0x2B
+#define HID_KEY_SPACE         0x2C
+#define HID_KEY_INSERT        0x49
+#define HID_KEY_HOME          0x4A
+#define HID_KEY_PAGE_UP       0x4B
+#define HID_KEY_DELETE        0x4C
+#define HID_KEY_END           0x4D
+#define HID_KEY_PAGE_DOWN     0x4E
+#define HID_KEY_ARROW_RIGHT   0x4F
+#define HID_KEY_ARROW_LEFT    0x50
+#define HID_KEY_ARROW_DOWN    0x51
+#define HID_KEY_ARROW_UP      0x52
+#define HID_KEY_KEYPAD_ENTER  0x58
+
+#define HID_KEYCODE_TO_ASCII \
+    {0     , 0     }, /* 0x00 */ \
+    {0     , 0     }, /* 0x01 */ \
+    {0     , 0     }, /* 0x02 */ \
+    {0     , 0     }, /* 0x03 */ \
+    {'a'   , 'A'   }, /* 0x04 */ \
+    {'b'   , 'B'   }, /* 0x05 */ \
+    {'c'   , 'C'   }, /* 0x06 */ \
+    {'d'   , 'D'   }, /* 0x07 */ \
+    {'e'   , 'E'   }, /* 0x08 */ \
+    {'f'   , 'F'   }, /* 0x09 */ \
+    {'g'   , 'G'   }, /* 0x0a */ \
+    {'h'   , 'H'   }, /* 0x0b */ \
+    {'i'   , 'I'   }, /* 0x0c */ \
+    {'j'   , 'J'   }, /* 0x0d */ \
+    {'k'   , 'K'   }, /* 0x0e */ \
+    {'l'   , 'L'   }, /* 0x0f */ \
+    {'m'   , 'M'   }, /* 0x10 */ \
+    {'n'   , 'N'   }, /* 0x11 */ \
+    {'o'   , 'O'   }, /* 0x12 */ \
+    {'p'   , 'P'   }, /* 0x13 */ \
+    {'q'   , 'Q'   }, /* 0x14 */ \
+    {'r'   , 'R'   }, /* 0x15 */ \
+    {'s'   , 'S'   }, /* 0x16 */ \
+    {'t'   , 'T'   }, /* 0x17 */ \
+    {'u'   , 'U'   }, /* 0x18 */ \
+    {'v'   , 'V'   }, /* 0x19 */ \
+    {'w'   , 'W'   }, /* 0x1a */ \
+    {'x'   , 'X'   }, /* 0x1b */ \
+    {'y'   , 'Y'   }, /* 0x1c */ \
+    {'z'   , 'Z'   }, /* 0x1d */ \
+    {'1'   , '!'   }, /* 0x1e */ \
+    {'2'   , '@'   }, /* 0x1f */ \
+    {'3'   , '#'   }, /* 0x20 */ \
+    {'4'   , '$'   }, /* 0x21 */ \
+    {'5'   , '%'   }, /* 0x22 */ \
+    {'6'   , '^'   }, /* 0x23 */ \
+    {'7'   , '&'   }, /* 0x24 */ \
+    {'8'   , '*'   }, /* 0x25 */ \
+    {'9'   , '('   }, /* 0x26 */ \
+    {'0'   , ')'   }, /* 0x27 */ \
+    {'\r'  , '\r'  }, /* 0x28 */ \
+    {'\x1b', '\x1b'}, /* 0x29 */ \
+    {'\b'  , '\b'  }, /* 0x2a */ \
+    {'\t'  , '\t'  }, /* 0x2b */ \
+    {' '   , ' '   }, /* 0x2c */ \
+    {'-'   , '_'   }, /* 0x2d */ \
+    {'='   , '+'   }, /* 0x2e */ \
+    {'['   , '{'   }, /* 0x2f */ \
+    {']'   , '}'   }, /* 0x30 */ \
+    {'\\'  , '|'   }, /* 0x31 */ \
+    {'#'   , '~'   }, /* 0x32 */ \
+    {';'   , ':'   }, /* 0x33 */ \
+    {'\''  , '\"'  }, /* 0x34 */ \
+    {'`'   , '~'   }, /* 0x35 */ \
+    {','   , '<'   }, /* 0x36 */ \
+    {'.'   , '>'   }, /* 0x37 */ \
+    {'/'   , '?'   }, /* 0x38 */ \
+    {0     , 0     }, /* 0x39 */ \
+    {0     , 0     }, /* 0x3a */ \
+    {0     , 0     }, /* 0x3b */ \
+    {0     , 0     }, /* 0x3c */ \
+    {0     , 0     }, /* 0x3d */ \
+    {0     , 0     }, /* 0x3e */ \
+    {0     , 0     }, /* 0x3f */ \
+    {0     , 0     }, /* 0x40 */ \
+    {0     , 0     }, /* 0x41 */ \
+    {0     , 0     }, /* 0x42 */ \
+    {0     , 0     }, /* 0x43 */ \
+    {0     , 0     }, /* 0x44 */ \
+    {0     , 0     }, /* 0x45 */ \
+    {0     , 0     }, /* 0x46 */ \
+    {0     , 0     }, /* 0x47 */ \
+    {0     , 0     }, /* 0x48 */ \
+    {0     , 0     }, /* 0x49 */ \
+    {0     , 0     }, /* 0x4a */ \
+    {0     , 0     }, /* 0x4b */ \
+    {0     , 0     }, /* 0x4c */ \
+    {0     , 0     }, /* 0x4d */ \
+    {0     , 0     }, /* 0x4e */ \
+    {0     , 0     }, /* 0x4f */ \
+    {0     , 0     }, /* 0x50 */ \
+    {0     , 0     }, /* 0x51 */ \
+    {0     , 0     }, /* 0x52 */ \
+    {0     , 0     }, /* 0x53 */ \
+    {'/'   , '/'   }, /* 0x54 */ \
+    {'*'   , '*'   }, /* 0x55 */ \
+    {'-'   , '-'   }, /* 0x56 */ \
+    {'+'   , '+'   }, /* 0x57 */ \
+    {'\r'  , '\r'  }, /* 0x58 */ \
+    {'1'   , 0     }, /* 0x59 */ \
+    {'2'   , 0     }, /* 0x5a */ \
+    {'3'   , 0     }, /* 0x5b */ \
+    {'4'   , 0     }, /* 0x5c */ \
+    {'5'   , 0     }, /* 0x5d */ \
+    {'6'   , 0     }, /* 0x5e */ \
+    {'7'   , 0     }, /* 0x5f */ \
+    {'8'   , 0     }, /* 0x60 */ \
+    {'9'   , 0     }, /* 0x61 */ \
+    {'0'   , 0     }, /* 0x62 */ \
+    {'.'   , 0     }, /* 0x63 */ \
+    {0     , 0     }, /* 0x64 */ \
+    {0     , 0     }, /* 0x65 */ \
+    {0     , 0     }, /* 0x66 */ \
+    {'='   , '='   }, /* 0x67 */ \
+    {0     , 0     }, /* 0x68 */ \
+    {0     , 0     }, /* 0x69 */ \
+    {0     , 0     }, /* 0x6a */ \
+    {0     , 0     }, /* 0x6b */ \
+    {0     , 0     }, /* 0x6c */ \
+    {0     , 0     }, /* 0x6d */ \
+    {0     , 0     }, /* 0x6e */ \
+    {0     , 0     }, /* 0x6f */ \
+    {0     , 0     }, /* 0x70 */ \
+    {0     , 0     }, /* 0x71 */ \
+    {0     , 0     }, /* 0x72 */ \
+    {0     , 0     }, /* 0x73 */ \
+    {0     , 0     }, /* 0x74 */ \
+    {0     , 0     }, /* 0x75 */ \
+    {0     , 0     }, /* 0x76 */ \
+    {0     , 0     }, /* 0x77 */ \
+    {0     , 0     }, /* 0x78 */ \
+    {0     , 0     }, /* 0x79 */ \
+    {0     , 0     }, /* 0x7a */ \
+    {0     , 0     }, /* 0x7b */ \
+    {0     , 0     }, /* 0x7c */ \
+    {0     , 0     }, /* 0x7d */ \
+    {0     , 0     }, /* 0x7e */ \
+    {0     , 0     }  /* 0x7f */
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t instance);
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t* report_info_arr, uint8_t arr_count, uint8_t const* desc_report, uint16_t desc_len);
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t instance);
+
+/**
+ * @brief make tuh_hid_interface_protocol() return protocol for every device;
+ * for host tests only
+ */
+void host_tuh_hid_set_interface_protocol(uint8_t protocol);
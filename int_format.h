@@ -0,0 +1,138 @@
+/**
+ * @file int_format.h
+ * @brief this class describes functions that format integers as fixed-width
+ * decimal or hexadecimal text without the printf family of functions.
+ *
+ * The spinner menu items redraw their numbers every time an encoder
+ * step changes them. snprintf() is slow on a Cortex-M0+ and pulls in a
+ * lot of code, so they use these functions instead.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <type_traits>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+namespace rppicomidi
+{
+template<typename T, typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
+class Int_format
+{
+public:
+    typedef typename std::make_unsigned<T>::type Unsigned_t;
+
+    /// the maximum number of characters in the decimal or hex text of any T value, not counting padding
+    static constexpr size_t max_chars = std::numeric_limits<Unsigned_t>::digits10 + 2;
+
+    /**
+     * @brief write value as base 10 text, padded with spaces to width characters
+     *
+     * This function writes the same text as snprintf() with format "%*d"
+     * (left_justify_ false) or "%-*d" (left_justify_ true).
+     *
+     * @param value the number to format
+     * @param str the buffer for the text; it must hold at least
+     * width_+1 and max_chars+1 characters
+     * @param width_ the minimum number of characters to write
+     * @param left_justify_ true to put the padding after the number
+     * @return the number of characters written, not counting the terminating '\0'
+     */
+    static constexpr size_t to_dec(T value, char* str, size_t width_, bool left_justify_)
+    {
+        char digits[max_chars] = {};
+        size_t ndigits = 0;
+        bool negative = is_negative(value);
+        Unsigned_t magnitude = negative ? Unsigned_t(0) - static_cast<Unsigned_t>(value) : static_cast<Unsigned_t>(value);
+        do {
+            digits[ndigits++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (negative)
+            digits[ndigits++] = '-';
+        return copy_reversed(digits, ndigits, str, width_, left_justify_ ? '\0' : ' ', left_justify_ ? ' ' : '\0');
+    }
+
+    /**
+     * @brief write value as upper case hex text, padded with leading zeros
+     * to width characters
+     *
+     * This function writes the same text as snprintf() with format "%0*X"
+     * except that a negative value is shown in the width of T, not in the
+     * width of an int.
+     *
+     * @param value the number to format
+     * @param str the buffer for the text; it must hold at least
+     * width_+1 and max_chars+1 characters
+     * @param width_ the minimum number of characters to write
+     * @return the number of characters written, not counting the terminating '\0'
+     */
+    static constexpr size_t to_hex(T value, char* str, size_t width_)
+    {
+        char digits[max_chars] = {};
+        size_t ndigits = 0;
+        Unsigned_t magnitude = static_cast<Unsigned_t>(value);
+        do {
+            digits[ndigits++] = "0123456789ABCDEF"[magnitude & 0xf];
+            magnitude >>= 4;
+        } while (magnitude != 0);
+        return copy_reversed(digits, ndigits, str, width_, '0', '\0');
+    }
+private:
+    // a helper so that comparing an unsigned value to 0 does not cause a warning
+    template<typename U = T>
+    static constexpr typename std::enable_if<std::is_signed<U>::value, bool>::type is_negative(U value) { return value < 0; }
+    template<typename U = T>
+    static constexpr typename std::enable_if<!std::is_signed<U>::value, bool>::type is_negative(U) { return false; }
+
+    /**
+     * @brief copy the ndigits characters in digits to str in reverse order,
+     * padding before them with lead_pad or after them with trail_pad
+     * so str is at least width_ characters long
+     *
+     * @param lead_pad the character to pad before the digits, or '\0' for none
+     * @param trail_pad the character to pad after the digits, or '\0' for none
+     */
+    static constexpr size_t copy_reversed(const char* digits, size_t ndigits, char* str, size_t width_, char lead_pad, char trail_pad)
+    {
+        size_t len = 0;
+        size_t npad = width_ > ndigits ? width_ - ndigits : 0;
+        if (lead_pad != '\0') {
+            // keep the sign before zero padding
+            if (lead_pad == '0' && digits[ndigits-1] == '-') {
+                str[len++] = digits[--ndigits];
+            }
+            for (; npad > 0; npad--)
+                str[len++] = lead_pad;
+        }
+        while (ndigits > 0)
+            str[len++] = digits[--ndigits];
+        if (trail_pad != '\0') {
+            for (; npad > 0; npad--)
+                str[len++] = trail_pad;
+        }
+        str[len] = '\0';
+        return len;
+    }
+};
+}
@@ -32,10 +32,11 @@
  */
 #pragma once
 #include <type_traits>
-#include <cstdio>
+#include <cassert>
 #include "view.h"
 #include "menu_item.h"
 #include "setting_number.h"
+#include "int_format.h"
 #include "mono_graphics_lib.h"
 namespace rppicomidi
 {
@@ -57,47 +58,80 @@ public:
      * @param incr_fn_ The function to increment (or decrement, if the int delta is negative) the setting value
      * @param context_ A pointer to the class that contains the static get_fn and incr_fn cast to void*
      */
-    Int_spinner_menu_item(const char* text_, Mono_graphics& screen_, const Mono_mono_font& font_,
+    Int_spinner_menu_item(const Menu_item_text& text_, Mono_graphics& screen_, const Mono_mono_font& font_,
         int ndigits_, int nhex_digits_, bool hex_format_,
         T (*get_fn_)(void*), T (*incr_fn_)(void*, int), void* context_, const char* units_=nullptr) :
         Menu_item{text_, screen_, font_},
         ndigits{ndigits_}, nhex_digits{nhex_digits_}, hex_format{hex_format_}, 
-        get_fn{get_fn_}, incr_fn{incr_fn_}, context{context_}
+        get_fn{get_fn_}, incr_fn{incr_fn_}, context{context_}, units_len{0},
+        dirty_fields{all_fields}, drawn_numstr_len{0}
     {
         editing = false;
         assert(ndigits >= nhex_digits);
+        assert(static_cast<size_t>(ndigits) <= Int_format<T>::max_chars);
         memset(units, 0, max_units_characters+1);
         if (units_)
             set_units(units_);
     }
 
-    
+
+    virtual void draw(uint8_t y_)
+    {
+        dirty_fields = all_fields;
+        drawn_numstr_len = 0;
+        Menu_item::draw(y_);
+    }
+
+    /**
+     * @brief draw the parts of the item that changed since the last redraw()
+     */
     virtual void redraw()
     {
-        if (is_hidden())
+        if (last_draw_y < 0 || is_hidden())
             return;
         T value = get_fn(context);
-        char numstr[ndigits+1+max_units_characters];
-        if (hex_format)
-            snprintf(numstr, nhex_digits+1+max_units_characters, "%0*X%s", nhex_digits, value, units);
-        else
-            snprintf(numstr, ndigits+1+max_units_characters, "%-*d%s", ndigits, value, units);
+        char numstr[Int_format<T>::max_chars+1+max_units_characters];
+        size_t number_len = hex_format ? Int_format<T>::to_hex(value, numstr, nhex_digits) :
+            Int_format<T>::to_dec(value, numstr, ndigits, true);
+        memcpy(numstr+number_len, units, units_len+1);
+        size_t numstr_len = number_len + units_len;
+        uint8_t value_x = text_len*font.width;
+        if (numstr_len != drawn_numstr_len) {
+            // the number did not fit its field, so the units moved
+            dirty_fields |= units_field;
+        }
 
-        if (is_highlighted() && !editing) {
-            // draw both the label and number in reverse text
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            screen.draw_string(font, strlen(text)*font.width, last_draw_y, numstr, strlen(numstr), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
+        // draw both the label and number in reverse text if highlighted and not
+        // editing; draw only the number in reverse text if editing
+        bool reverse_label = is_highlighted() && !editing;
+        bool reverse_value = reverse_label || editing;
+        Pixel_state value_fg = reverse_value ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE;
+        Pixel_state value_bg = reverse_value ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO;
+        if (dirty_fields & label_field) {
+            screen.draw_string(font, 0, last_draw_y, text, text_len,
+                reverse_label ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE,
+                reverse_label ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO);
         }
-        else {
-            // 
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-            if (editing) {
-                screen.draw_string(font, strlen(text)*font.width, last_draw_y, numstr, strlen(numstr), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
-            }
-            else {
-                screen.draw_string(font, strlen(text)*font.width, last_draw_y, numstr, strlen(numstr), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+        if (dirty_fields & units_field) {
+            screen.draw_string(font, value_x, last_draw_y, numstr, numstr_len, value_fg, value_bg);
+            if (drawn_numstr_len > numstr_len) {
+                // erase the end of the longer value drawn before
+                screen.draw_rectangle(value_x + numstr_len*font.width, last_draw_y, (drawn_numstr_len - numstr_len)*font.width, font.height,
+                    Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
             }
         }
+        else if (dirty_fields & number_field) {
+            screen.draw_string(font, value_x, last_draw_y, numstr, number_len, value_fg, value_bg);
+        }
+        drawn_numstr_len = numstr_len;
+        dirty_fields = 0;
+    }
+
+    virtual void set_highlighted(bool highlighted_)
+    {
+        if (highlighted_ != highlighted)
+            dirty_fields = all_fields;
+        Menu_item::set_highlighted(highlighted_);
     }
 
     void entry() final
@@ -109,6 +143,7 @@ public:
     {
         editing = false;
         last_draw_y=-1;
+        dirty_fields = all_fields;
     }
 
     void on_increment(uint32_t delta, bool is_shifted) final    
@@ -130,7 +165,8 @@ public:
     virtual View::Select_result on_select(View**)
     {
         editing = !editing;
-        redraw();
+        dirty_fields = all_fields;
+        invalidate();
         if (editing)
             return View::Select_result::take_focus;
         return View::Select_result::give_focus;
@@ -140,18 +176,30 @@ public:
     {
         strncpy(units, units_, max_units_characters);
         units[max_units_characters]='\0';
+        units_len = strlen(units);
+        dirty_fields = all_fields;
     }
 
-    void set_display_hex(bool is_hex) { hex_format = is_hex; }
+    void set_display_hex(bool is_hex) { hex_format = is_hex; dirty_fields = all_fields; }
 protected:
+    /// the parts of the item redraw() has to draw
+    enum Field {
+        label_field = 1,
+        number_field = 2,
+        units_field = 4,    //!< the units and the number, because the units follow the number
+        all_fields = label_field | number_field | units_field,
+    };
+
     void incr(int delta)
     {
         if (!editing)
             return;
         T oldval = get_fn(context);
         T newval = incr_fn(context, delta);
-        if (oldval != newval)
-            redraw();
+        if (oldval != newval) {
+            dirty_fields |= number_field;
+            invalidate();
+        }
     }
     int ndigits;
     int nhex_digits;
@@ -161,6 +209,9 @@ protected:
     void* context;
     bool editing;       //<! true if editing the int value; false if displaying the number as text only
     static const uint8_t max_units_characters=4;
-    char units[max_units_characters];
+    char units[max_units_characters+1];
+    size_t units_len;
+    uint8_t dirty_fields;       //!< the Field bits for the parts that changed since the last redraw()
+    size_t drawn_numstr_len;    //!< the length of the number and units the last redraw() drew
 };
 }
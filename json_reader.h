@@ -0,0 +1,447 @@
+/**
+ * @file json_reader.h
+ *
+ * This class parses JSON text without building a parson tree. The text
+ * can arrive in chunks of any size, and the parser only needs memory for
+ * one key, string or number at a time, so reading a settings file of any
+ * size takes a small, fixed amount of memory.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+namespace rppicomidi
+{
+/**
+ * @brief one thing a Json_reader found in the JSON text
+ */
+struct Json_event
+{
+    enum Type : uint8_t {
+        begin_object,
+        end_object,
+        begin_array,
+        end_array,
+        key,        //!< the name of an object member; the member value follows
+        string,
+        number,
+        boolean,
+        null,
+    };
+    Type type;
+    uint8_t depth;      //!< the number of objects and arrays that contain this event
+    size_t index;       //!< the index of a value in its array, or for end_array, the number of values in the array
+    const char* str;    //!< the nul terminated key or string; it is only valid during the event
+    size_t str_len;
+    double value;       //!< the number, or for boolean, 1 for true and 0 for false
+};
+
+/**
+ * @brief a JSON parser that gets the JSON text in chunks of any size and
+ * calls an event function for each key, value and start and end of each
+ * object or array, the way a SAX parser does
+ */
+class Json_reader
+{
+public:
+    static const size_t max_token_len = 63;     //!< the longest key, string or number the reader accepts
+    static const uint8_t max_depth = 16;        //!< the most objects and arrays that can be open at once
+
+    /**
+     * @brief Construct a new Json_reader object
+     *
+     * @param event_fn_ the function that gets each event; it returns false
+     * to stop the reader with an error
+     * @param context_ the context pointer for event_fn_
+     */
+    Json_reader(bool (*event_fn_)(void* context, const Json_event& event), void* context_) :
+        event_fn{event_fn_}, context{context_}, state{State::value}, depth{0}, token_len{0},
+        is_key{false}, escape_len{0}, code_point{0} {}
+    Json_reader()=delete;
+
+    /**
+     * @brief parse the next len characters of the JSON text
+     *
+     * @return false if the text is not legal JSON, a key, string or number
+     * is too long, the nesting is too deep, or event_fn returned false
+     */
+    bool feed(const char* data, size_t len)
+    {
+        for (size_t idx = 0; idx < len && state != State::error;) {
+            if (parse(data[idx]))
+                ++idx;
+        }
+        return state != State::error;
+    }
+
+    /**
+     * @brief tell the reader the JSON text is complete
+     *
+     * @return true if the text was exactly one legal JSON value
+     */
+    bool finish()
+    {
+        if (state == State::number || state == State::literal)
+            end_token();
+        return state == State::done;
+    }
+private:
+    enum class State : uint8_t {
+        value,          //!< expect a value
+        value_or_end,   //!< expect a value or ']' after '['
+        key,            //!< expect a key after ','
+        key_or_end,     //!< expect a key or '}' after '{'
+        colon,          //!< expect ':' after a key
+        after_value,    //!< expect ',' or the end of an object or array
+        string,
+        number,
+        literal,        //!< true, false or null
+        done,
+        error,
+    };
+
+    static bool is_space(char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; }
+
+    /**
+     * @brief parse one character
+     *
+     * @return false if the character ended a number or literal and must be
+     * parsed again in the new state
+     */
+    bool parse(char ch)
+    {
+        switch (state) {
+        case State::value:
+        case State::value_or_end:
+            if (is_space(ch))
+                break;
+            if (ch == ']' && state == State::value_or_end) {
+                close(ch);
+                break;
+            }
+            begin_value(ch);
+            break;
+        case State::key:
+        case State::key_or_end:
+            if (is_space(ch))
+                break;
+            if (ch == '"') {
+                is_key = true;
+                token_len = 0;
+                state = State::string;
+            }
+            else if (ch == '}' && state == State::key_or_end) {
+                close(ch);
+            }
+            else {
+                state = State::error;
+            }
+            break;
+        case State::colon:
+            if (is_space(ch))
+                break;
+            state = ch == ':' ? State::value : State::error;
+            break;
+        case State::after_value:
+            if (is_space(ch))
+                break;
+            if (ch == ',' && depth > 0)
+                state = containers[depth-1].is_object ? State::key : State::value;
+            else if (ch == '}' || ch == ']')
+                close(ch);
+            else
+                state = State::error;
+            break;
+        case State::string:
+            parse_string(ch);
+            break;
+        case State::number:
+            if ((ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E') {
+                put_token(ch);
+                break;
+            }
+            end_token();
+            return false;
+        case State::literal:
+            if (ch >= 'a' && ch <= 'z') {
+                put_token(ch);
+                break;
+            }
+            end_token();
+            return false;
+        case State::done:
+            if (!is_space(ch))
+                state = State::error;
+            break;
+        case State::error:
+            break;
+        }
+        return true;
+    }
+
+    void begin_value(char ch)
+    {
+        token_len = 0;
+        if (ch == '{' || ch == '[') {
+            bool is_object = ch == '{';
+            if (depth == max_depth) {
+                state = State::error;
+                return;
+            }
+            emit(is_object ? Json_event::begin_object : Json_event::begin_array);
+            containers[depth].is_object = is_object;
+            containers[depth].count = 0;
+            ++depth;
+            if (state != State::error)
+                state = is_object ? State::key_or_end : State::value_or_end;
+        }
+        else if (ch == '"') {
+            is_key = false;
+            state = State::string;
+        }
+        else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            put_token(ch);
+            state = State::number;
+        }
+        else if (ch >= 'a' && ch <= 'z') {
+            put_token(ch);
+            state = State::literal;
+        }
+        else {
+            state = State::error;
+        }
+    }
+
+    void close(char ch)
+    {
+        if (depth == 0 || containers[depth-1].is_object != (ch == '}')) {
+            state = State::error;
+            return;
+        }
+        size_t count = containers[depth-1].count;
+        --depth;
+        emit(ch == '}' ? Json_event::end_object : Json_event::end_array, count);
+        end_value();
+    }
+
+    /// go to the state after a value, and count the value if it is in an array
+    void end_value()
+    {
+        if (state == State::error)
+            return;
+        if (depth == 0) {
+            state = State::done;
+        }
+        else {
+            ++containers[depth-1].count;
+            state = State::after_value;
+        }
+    }
+
+    void parse_string(char ch)
+    {
+        if (escape_len == 0) {
+            if (ch == '"') {
+                token[token_len] = '\0';
+                if (is_key) {
+                    emit(Json_event::key);
+                    if (state != State::error)
+                        state = State::colon;
+                }
+                else {
+                    emit(Json_event::string);
+                    end_value();
+                }
+            }
+            else if (ch == '\\') {
+                escape_len = 1;
+            }
+            else if (static_cast<uint8_t>(ch) < 0x20) {
+                state = State::error;
+            }
+            else {
+                put_token(ch);
+            }
+        }
+        else if (escape_len == 1) {
+            const char* escapes = "\"\\/bfnrt";
+            const char* unescaped = "\"\\/\b\f\n\r\t";
+            const char* found = ch != '\0' ? strchr(escapes, ch) : nullptr;
+            if (found) {
+                put_token(unescaped[found - escapes]);
+                escape_len = 0;
+            }
+            else if (ch == 'u') {
+                code_point = 0;
+                escape_len = 2;
+            }
+            else {
+                state = State::error;
+            }
+        }
+        else {
+            // one of the 4 hex digits of a \u escape
+            uint32_t digit;
+            if (ch >= '0' && ch <= '9')
+                digit = ch - '0';
+            else if (ch >= 'a' && ch <= 'f')
+                digit = ch - 'a' + 10;
+            else if (ch >= 'A' && ch <= 'F')
+                digit = ch - 'A' + 10;
+            else {
+                state = State::error;
+                return;
+            }
+            code_point = (code_point << 4) | digit;
+            if (++escape_len == 6) {
+                escape_len = 0;
+                put_utf8(code_point);
+            }
+        }
+    }
+
+    /// add the UTF-8 bytes of a code point from a \u escape; surrogate pairs are not supported
+    void put_utf8(uint32_t code)
+    {
+        if (code < 0x80) {
+            put_token(static_cast<char>(code));
+        }
+        else if (code < 0x800) {
+            put_token(static_cast<char>(0xc0 | (code >> 6)));
+            put_token(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        else if (code < 0xd800 || code > 0xdfff) {
+            put_token(static_cast<char>(0xe0 | (code >> 12)));
+            put_token(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            put_token(static_cast<char>(0x80 | (code & 0x3f)));
+        }
+        else {
+            state = State::error;
+        }
+    }
+
+    void put_token(char ch)
+    {
+        if (token_len == max_token_len)
+            state = State::error;
+        else
+            token[token_len++] = ch;
+    }
+
+    /// emit the number or literal in the token buffer
+    void end_token()
+    {
+        token[token_len] = '\0';
+        if (state == State::number) {
+            double value;
+            if (!parse_integer(value)) {
+                char* end;
+                value = strtod(token, &end);
+                if (end != token + token_len || token[token_len-1] == '.') {
+                    state = State::error;
+                    return;
+                }
+            }
+            emit(Json_event::number, 0, value);
+        }
+        else if (strcmp(token, "true") == 0) {
+            emit(Json_event::boolean, 0, 1);
+        }
+        else if (strcmp(token, "false") == 0) {
+            emit(Json_event::boolean, 0, 0);
+        }
+        else if (strcmp(token, "null") == 0) {
+            emit(Json_event::null);
+        }
+        else {
+            state = State::error;
+            return;
+        }
+        end_value();
+    }
+
+    /**
+     * @brief convert the token to value without strtod() if it is an
+     * integer of up to 9 digits, which most setting values are
+     *
+     * @return false if the token is not such an integer
+     */
+    bool parse_integer(double& value) const
+    {
+        bool negative = token[0] == '-';
+        size_t first = negative ? 1 : 0;
+        if (token_len == first || token_len - first > 9)
+            return false;
+        int32_t magnitude = 0;
+        for (size_t idx = first; idx < token_len; idx++) {
+            if (token[idx] < '0' || token[idx] > '9')
+                return false;
+            magnitude = magnitude * 10 + (token[idx] - '0');
+        }
+        value = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    /**
+     * @brief send an event to event_fn
+     *
+     * @param count for end_object and end_array, the number of values in the object or array
+     */
+    void emit(Json_event::Type type, size_t count = 0, double number = 0)
+    {
+        Json_event event;
+        event.type = type;
+        event.depth = depth;
+        if (type == Json_event::end_array || type == Json_event::end_object)
+            event.index = count;
+        else
+            event.index = (depth > 0 && !containers[depth-1].is_object) ? containers[depth-1].count : 0;
+        bool has_str = type == Json_event::key || type == Json_event::string;
+        event.str = has_str ? token : nullptr;
+        event.str_len = has_str ? token_len : 0;
+        event.value = number;
+        if (!event_fn(context, event))
+            state = State::error;
+    }
+
+    /// an object or array that is open
+    struct Container {
+        bool is_object;
+        size_t count;   //!< the number of values in the container so far
+    };
+
+    bool (*event_fn)(void* context, const Json_event& event);
+    void* context;
+    State state;
+    uint8_t depth;                      //!< the number of open objects and arrays
+    Container containers[max_depth];
+    char token[max_token_len + 1];      //!< the key, string, number or literal being parsed
+    size_t token_len;
+    bool is_key;                        //!< true if the string being parsed is a key
+    uint8_t escape_len;                 //!< 0 if not in an escape, 1 after '\\', 2 to 5 in the hex digits of a \u escape
+    uint32_t code_point;                //!< the hex digits of a \u escape so far
+};
+}
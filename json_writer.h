@@ -0,0 +1,231 @@
+/**
+ * @file json_writer.h
+ *
+ * This class writes JSON text straight to a fixed size buffer, without
+ * building a parson tree first. When the buffer is full, it can pass the
+ * text to a function that stores it, so JSON text of any length needs
+ * only the buffer. The text is the same text json_serialize_to_string()
+ * makes from the same values.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <cassert>
+#include "int_format.h"
+namespace rppicomidi
+{
+class Json_writer
+{
+public:
+    /**
+     * @brief Construct a new Json_writer object
+     *
+     * @param buffer_ the buffer for the JSON text
+     * @param buffer_size_ the size of the buffer in bytes
+     * @param flush_fn_ if not nullptr, the function that gets the buffer
+     * contents each time the buffer is full and when finish() is called;
+     * it returns false if it cannot store the data. If nullptr, the JSON
+     * text must fit in the buffer, and finish() adds a terminating '\0'.
+     * @param context_ the context pointer for flush_fn_
+     */
+    Json_writer(char* buffer_, size_t buffer_size_,
+        bool (*flush_fn_)(void* context, const char* data, size_t len)=nullptr, void* context_=nullptr) :
+        buffer{buffer_}, buffer_size{buffer_size_}, flush_fn{flush_fn_}, context{context_},
+        len{0}, flushed_len{0}, failed{buffer_size_ == 0}, depth{0}, need_comma{0}, after_key{false} {}
+    Json_writer()=delete;
+
+    void begin_object() { begin_value(); open('{'); }
+    void end_object() { close('}'); }
+    void begin_array() { begin_value(); open('['); }
+    void end_array() { close(']'); }
+
+    /**
+     * @brief write the name of the next value in an object
+     */
+    void key(const char* name)
+    {
+        begin_value();
+        put_string(name);
+        put(':');
+        after_key = true;
+    }
+
+    void string(const char* str)
+    {
+        begin_value();
+        put_string(str);
+    }
+
+    /**
+     * @brief write value in the same format json_serialize_to_string() uses:
+     * an integer if value is one, otherwise 17 significant digits
+     */
+    void number(double value)
+    {
+        begin_value();
+        if (value >= INT_MIN && value <= INT_MAX && value == static_cast<double>(static_cast<int>(value))) {
+            char numstr[Int_format<int>::max_chars+1];
+            put(numstr, Int_format<int>::to_dec(static_cast<int>(value), numstr, 0, false));
+        }
+        else {
+            char numstr[32];
+            int numstr_len = snprintf(numstr, sizeof(numstr), "%1.17g", value);
+            put(numstr, static_cast<size_t>(numstr_len));
+        }
+    }
+
+    /**
+     * @brief write the rest of the JSON text
+     *
+     * @return false if the text did not fit in the buffer or flush_fn failed
+     */
+    bool finish()
+    {
+        if (flush_fn) {
+            flush();
+        }
+        else {
+            put('\0');
+            if (!failed)
+                --len; // so get_length() does not count the '\0'
+        }
+        return !failed;
+    }
+
+    /**
+     * @brief get the number of characters written so far, not counting
+     * the terminating '\0'
+     */
+    size_t get_length() const { return flushed_len + len; }
+
+    bool ok() const { return !failed; }
+private:
+    /// write a comma if the value is not the first in its object or array
+    void begin_value()
+    {
+        if (after_key) {
+            after_key = false;
+        }
+        else {
+            if (need_comma & (1u << depth))
+                put(',');
+            need_comma |= 1u << depth;
+        }
+    }
+
+    void open(char ch)
+    {
+        put(ch);
+        ++depth;
+        assert(depth < 32);
+        need_comma &= ~(1u << depth);
+    }
+
+    void close(char ch)
+    {
+        assert(depth > 0);
+        --depth;
+        put(ch);
+    }
+
+    /// write str in quotes with the characters escaped the way parson escapes them
+    void put_string(const char* str)
+    {
+        put('"');
+        const char* run = str;
+        for (; *str != '\0'; str++) {
+            const char* escape;
+            char hex[7];
+            switch (*str) {
+            case '"': escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '/': escape = "\\/"; break;
+            case '\b': escape = "\\b"; break;
+            case '\f': escape = "\\f"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
+            default:
+                if (static_cast<uint8_t>(*str) >= 0x20)
+                    continue;
+                snprintf(hex, sizeof(hex), "\\u%04x", static_cast<uint8_t>(*str));
+                escape = hex;
+                break;
+            }
+            // write the characters that need no escape in one copy
+            put(run, str - run);
+            put(escape, strlen(escape));
+            run = str + 1;
+        }
+        put(run, str - run);
+        put('"');
+    }
+
+    void put(char ch) { put(&ch, 1); }
+
+    void put(const char* str, size_t nchars)
+    {
+        while (nchars != 0 && !failed) {
+            if (len == buffer_size) {
+                flush();
+                if (failed)
+                    return;
+            }
+            size_t nbytes = buffer_size - len;
+            if (nbytes > nchars)
+                nbytes = nchars;
+            memcpy(buffer + len, str, nbytes);
+            len += nbytes;
+            str += nbytes;
+            nchars -= nbytes;
+        }
+    }
+
+    void flush()
+    {
+        if (flush_fn && !failed && (len == 0 || flush_fn(context, buffer, len))) {
+            flushed_len += len;
+            len = 0;
+        }
+        else {
+            failed = true;
+        }
+    }
+
+    char* buffer;
+    size_t buffer_size;
+    bool (*flush_fn)(void* context, const char* data, size_t len);
+    void* context;
+    size_t len;             //!< the number of characters in the buffer
+    size_t flushed_len;     //!< the number of characters flush_fn got
+    bool failed;
+    uint8_t depth;          //!< the number of objects and arrays that are open
+    uint32_t need_comma;    //!< bit n is set if the next value at depth n needs a comma first
+    bool after_key;         //!< true if the next value follows a key
+};
+}
@@ -23,12 +23,24 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#include <algorithm>
 #include "menu.h"
 
 rppicomidi::Menu::~Menu()
 {
     for (auto& item:items)
-        delete item;
+        delete_menu_item(item);
+}
+
+void rppicomidi::Menu::delete_menu_item(Menu_item* item_)
+{
+    if (item_allocator && item_allocator->owns(item_)) {
+        item_->~Menu_item();
+        item_allocator->deallocate(item_);
+    }
+    else {
+        delete item_;
+    }
 }
 
 void rppicomidi::Menu::on_decrement(uint32_t delta, bool is_shifted)
@@ -38,57 +50,16 @@ void rppicomidi::Menu::on_decrement(uint32_t delta, bool is_shifted)
         if (has_focus) {
             if (is_shifted)
                 delta += 5; // down arrow becomes page down
-            // then navigate to the next visible item if not already
-            // at the end of the list (TODO: implement scrolling)
-            if (delta > 1) {
-                // make sure we are not navigating past the end of the list
-                uint32_t new_delta = 1;
-                while (new_delta < delta && current_item+new_delta != items.end())
-                    ++new_delta;
-                if (current_item+new_delta == items.end()) {
-                    if (new_delta > 1) {
-                        delta = new_delta - 1; // can still advance
-                    }
-                    else {
-                        delta = 1;  // already at the end of the list
-                    }
-                } // otherwise, the given delta is fine
-            }
-            if (current_item+delta != items.end() ) {
-                auto next_item = current_item+delta;
-                while ((*next_item)->is_hidden() && next_item + 1 != items.end()) {
-                    next_item++;
-                }
-                if (current_item != next_item) {
-                    if ((*next_item)->is_hidden()) {
-                        if (delta > 1) {
-                            // can't advance by delta or more, but maybe by less than delta
-                            --delta;
-                            next_item = current_item + delta;
-                            while (delta > 0 && (*next_item)->is_hidden()) {
-                                --delta;
-                                next_item = current_item + delta;
-                            }
-                            if (delta > 0) {
-                                (*current_item)->set_highlighted(false);
-                                while(next_item >= items.begin()+scroll_offset+max_visisble_items) {
-                                    ++scroll_offset;
-                                }
-                                current_item = next_item;
-                                draw();
-                            }
-                        }
-                    }
-                    else {
-                        (*current_item)->set_highlighted(false);
-                        while(next_item >= items.begin()+scroll_offset+max_visisble_items) {
-                            ++scroll_offset;
-                        }
-                        current_item = next_item;
-                        draw();
-                    }
-                } 
-            }
+            // navigate to the first visible item at least delta items down the list.
+            // If there isn't one, navigate to the last visible item in the list.
+            int idx = get_current_item_idx();
+            int last_idx = static_cast<int>(items.size()) - 1;
+            int target = delta > static_cast<uint32_t>(last_idx - idx) ? last_idx : idx + static_cast<int>(delta);
+            auto next = std::lower_bound(visible_idx.begin(), visible_idx.end(), target);
+            if (next == visible_idx.end() && next != visible_idx.begin())
+                --next;
+            if (next != visible_idx.end() && *next > idx)
+                move_current_item(items.begin() + *next);
         }
         else {
             (*current_item)->on_decrement(delta, is_shifted);
@@ -102,54 +73,16 @@ void rppicomidi::Menu::on_increment(uint32_t delta, bool is_shifted)
         // then list is not empty and delta > 0
         if (has_focus) {
             if (is_shifted)
-                delta += 5; // down arrow becomes page down
-            // then navigate to the next visible item if not
-            // already at the beginning of the list (TODO: implement scrolling)
-            if (delta > 1) {
-
-                // make sure we are not navigating before the beginning of the list
-                uint32_t new_delta = 0;
-                while (new_delta < delta && current_item - new_delta != items.begin()) {
-                    ++new_delta;
-                }
-                if (new_delta > 0)
-                    delta = new_delta;
-            }
-            if (current_item != items.begin()) {
-                auto next_item = current_item-delta;
-                while ((*next_item)->is_hidden() && next_item != items.begin()) {
-                    next_item--;
-                }
-                if (current_item != next_item) {
-                    if ((*next_item)->is_hidden()) {
-                        if (delta > 1) {
-                            // can't advance by delta or more, but maybe by less than delta
-                            --delta;
-                            next_item = current_item - delta;
-                            while (delta > 0 && (*next_item)->is_hidden()) {
-                                --delta;
-                                next_item = current_item - delta;
-                            }
-                            if (delta > 0) {
-                                (*current_item)->set_highlighted(false);
-                                while(scroll_offset && next_item < items.begin()+scroll_offset) {
-                                    --scroll_offset;
-                                }
-                                current_item = next_item;
-                                draw();
-                            }
-                        }
-                    }
-                    else {
-                        (*current_item)->set_highlighted(false);
-                        while(scroll_offset && next_item < items.begin()+scroll_offset) {
-                            --scroll_offset;
-                        }
-                        current_item = next_item;
-                        draw();
-                    }
-                }
-            }
+                delta += 5; // up arrow becomes page up
+            // navigate to the first visible item at least delta items up the list.
+            // If there isn't one, navigate to the first visible item in the list.
+            int idx = get_current_item_idx();
+            int target = delta > static_cast<uint32_t>(idx) ? 0 : idx - static_cast<int>(delta);
+            auto next = std::upper_bound(visible_idx.begin(), visible_idx.end(), target);
+            if (next != visible_idx.begin())
+                --next;
+            if (next != visible_idx.end() && *next < idx)
+                move_current_item(items.begin() + *next);
         }
         else {
             (*current_item)->on_increment(delta, is_shifted);
@@ -157,6 +90,117 @@ void rppicomidi::Menu::on_increment(uint32_t delta, bool is_shifted)
     }
 }
 
+void rppicomidi::Menu::move_current_item(std::vector<Menu_item*>::iterator next_item)
+{
+    int prev_scroll_offset = scroll_offset;
+    (*current_item)->set_highlighted(false);
+    mark_row_dirty(current_item);
+    scroll_to_visible_pos(get_visible_pos(next_item - items.begin()));
+    current_item = next_item;
+    if (scroll_offset != prev_scroll_offset) {
+        // every row moved
+        invalidate();
+    }
+    else {
+        (*current_item)->set_highlighted(true);
+        mark_row_dirty(current_item);
+        if (!is_render_deferred())
+            redraw_dirty_rows();
+    }
+}
+
+void rppicomidi::Menu::render()
+{
+    if (draw_pending)
+        draw();
+    else if (dirty_rows != 0)
+        redraw_dirty_rows();
+}
+
+void rppicomidi::Menu::mark_row_dirty(std::vector<Menu_item*>::iterator item_)
+{
+    if ((*item_)->is_hidden())
+        return;
+    int row = get_visible_pos(item_ - items.begin()) - get_visible_pos(scroll_offset);
+    if (row >= 0 && row < max_visisble_items)
+        dirty_rows |= (1ul << row);
+}
+
+void rppicomidi::Menu::redraw_dirty_rows()
+{
+    int first_row = get_visible_pos(scroll_offset);
+    for (int row = 0; dirty_rows != 0; row++) {
+        if (dirty_rows & (1ul << row)) {
+            dirty_rows &= ~(1ul << row);
+            // skip items that draw() did not place on the screen
+            if (first_row + row < static_cast<int>(visible_idx.size())) {
+                auto item = items[visible_idx[first_row + row]];
+                if (item->is_drawn())
+                    item->redraw();
+            }
+        }
+    }
+}
+
+int rppicomidi::Menu::get_visible_pos(int idx)
+{
+    return std::lower_bound(visible_idx.begin(), visible_idx.end(), idx) - visible_idx.begin();
+}
+
+void rppicomidi::Menu::scroll_to_visible_pos(int row)
+{
+    int first_row = get_visible_pos(scroll_offset);
+    if (row < first_row) {
+        scroll_offset = visible_idx[row];
+    }
+    else if (row >= first_row + max_visisble_items) {
+        scroll_offset = visible_idx[row - max_visisble_items + 1];
+    }
+}
+
+void rppicomidi::Menu::renumber_items(int first_idx, bool inserted)
+{
+    int nitems = static_cast<int>(items.size());
+    for (int idx = first_idx; idx < nitems; idx++) {
+        items[idx]->set_owner_idx(idx);
+    }
+    auto pos = std::lower_bound(visible_idx.begin(), visible_idx.end(), first_idx);
+    if (inserted) {
+        for (auto it = pos; it != visible_idx.end(); it++)
+            ++(*it);
+        if (!items[first_idx]->is_hidden())
+            visible_idx.insert(pos, first_idx);
+    }
+    else {
+        if (pos != visible_idx.end() && *pos == first_idx)
+            pos = visible_idx.erase(pos);
+        for (auto it = pos; it != visible_idx.end(); it++)
+            --(*it);
+    }
+    // the items that the last draw() drew may have moved
+    drawn_begin = 0;
+    drawn_end = nitems;
+}
+
+void rppicomidi::Menu::item_changed(void* context, int idx, Menu_item::Change change)
+{
+    auto me = reinterpret_cast<Menu*>(context);
+    if (change == Menu_item::appearance_changed) {
+        me->mark_row_dirty(me->items.begin() + idx);
+        if (!is_render_deferred())
+            me->redraw_dirty_rows();
+        return;
+    }
+    auto pos = std::lower_bound(me->visible_idx.begin(), me->visible_idx.end(), idx);
+    if (me->items[idx]->is_hidden()) {
+        if (pos != me->visible_idx.end() && *pos == idx)
+            me->visible_idx.erase(pos);
+    }
+    else if (pos == me->visible_idx.end() || *pos != idx) {
+        me->visible_idx.insert(pos, idx);
+    }
+}
+
 rppicomidi::Menu::Select_result rppicomidi::Menu::on_select(View** new_view)
 {
     Select_result result = View::no_op;
@@ -175,18 +219,15 @@ rppicomidi::Menu::Select_result rppicomidi::Menu::on_select(View** new_view)
 int rppicomidi::Menu::set_current_item_idx(int idx)
 {
     if (idx >= 0 && idx < (int)items.size()) {
-        if (idx < scroll_offset) {
-            scroll_offset = idx;
-        }
-        else if (idx >+ scroll_offset + max_visisble_items) {
-            scroll_offset = idx - max_visisble_items + 1;
-        }
+        // Adjust scroll_offset in case the current item is not visible
+        int row = get_visible_pos(idx);
+        if (row < static_cast<int>(visible_idx.size()))
+            scroll_to_visible_pos(row);
 
         if (has_focus)
             (*current_item)->exit();
         (*current_item)->set_highlighted(false);
         current_item = items.begin() + idx;
-        // Adjust scroll_offset in case the current item is not visible;
     }
     else {
         idx = -1;
@@ -196,47 +237,39 @@ int rppicomidi::Menu::set_current_item_idx(int idx)
 
 void rppicomidi::Menu::draw()
 {
+    draw_pending = false;
+    dirty_rows = 0;
     // Clear the bounding rectangle
     screen.draw_rectangle(view_rect, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
     if (items.size() == 0)
         return;
-    // figure out items statistics for the vertical scroll bar, in case it's required
-    int invisible_items = 0;
-    int items_drawn = 0;
-    int visible_items = 0;
-    int scrolled_past_items = 0;
-    int current_offset = 0;
-    for (auto& item : items) {
-        item->exit();
-        if (!item->is_hidden()) {
-            ++visible_items;
-            if (current_offset < scroll_offset)
-                ++scrolled_past_items;
-        }
-        ++current_offset;
+    // Forget where the items that the last draw() drew were
+    for (int idx = drawn_begin; idx < drawn_end && idx < static_cast<int>(items.size()); idx++) {
+        items[idx]->exit();
     }
+    drawn_begin = drawn_end = 0;
+    int num_visible_items = static_cast<int>(visible_idx.size());
+    if (num_visible_items == 0)
+        return;
     (*current_item)->set_highlighted(true);
+    // Showing or hiding items may have moved the current item out of the window
+    int current_row = get_visible_pos(get_current_item_idx());
+    if (current_row < num_visible_items)
+        scroll_to_visible_pos(current_row);
 
-    for (auto item=items.begin()+scroll_offset; item != items.end() && item < items.begin()+scroll_offset+max_visisble_items-invisible_items; item++) {        
-        if (!(*item)->is_hidden()) {
-            (*item)->entry();
-            (*item)->draw(items_drawn*menu_font.height+view_rect.y_upper_left);
-            ++items_drawn;
-        }
-        else {
-            ++invisible_items;
-        }
+    int first_row = get_visible_pos(scroll_offset);
+    int items_drawn = 0;
+    for (int row = first_row; row < num_visible_items && items_drawn < max_visisble_items; row++) {
+        auto item = items[visible_idx[row]];
+        item->entry();
+        item->draw(items_drawn*menu_font.height+view_rect.y_upper_left);
+        ++items_drawn;
     }
-    if (items_drawn < visible_items) {
-        // show a vertical scroll bar
-        uint8_t scroll_bar_width = 4;
-        uint8_t scroll_bar_x = screen.get_screen_width()-scroll_bar_width;
-        screen.draw_rectangle(scroll_bar_x, view_rect.y_upper_left, scroll_bar_width, view_rect.height,
-            Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
-        uint8_t rect_height = items_drawn * view_rect.height / visible_items;
-        uint8_t rect_y = (scrolled_past_items * view_rect.height / visible_items) + view_rect.y_upper_left;
-        screen.draw_rectangle(scroll_bar_x, rect_y, scroll_bar_width, rect_height,
-            Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
-
+    if (items_drawn > 0) {
+        drawn_begin = visible_idx[first_row];
+        drawn_end = visible_idx[first_row + items_drawn - 1] + 1;
+    }
+    if (items_drawn < num_visible_items) {
+        draw_scroll_bar(first_row, items_drawn, num_visible_items);
     }
 }
@@ -3,8 +3,10 @@
  * @brief this class describes the interface for a text-based menu.
  * 
  * A menu has a vector of pointers to Menu_item objects. The Menu_item
- * objects must be allocated with operator new because the Menu class deletes
- * every Menu_item in its vector in the Menu class destructor. The Menu object
+ * objects must be allocated with operator new or with new_menu_item()
+ * because the Menu class deletes every Menu_item in its vector in the
+ * Menu class destructor. If the Menu has a Menu_item_allocator, then
+ * new_menu_item() allocates the Menu_item objects from it. The Menu object
  * specifies the font for rendering all Menu_item object. A Menu has a bounding
  * rectangle that is a multiple of the Menu_item font height and is the
  * width of the screen. A Menu will only display as many Menu_item objects
@@ -39,50 +41,98 @@
 #pragma once
 #include "view.h"
 #include "menu_item.h"
+#include "menu_item_pool.h"
 #include <vector>
+#include <new>
+#include <utility>
+#include <cassert>
 namespace rppicomidi {
 class Menu : public View {
 public:
     Menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_) : 
         View(screen_, Rectangle{0,y_,screen_.get_screen_width(), static_cast<uint8_t>(screen_.get_screen_height() - y_)}),
         menu_font{menu_font_},
-        scroll_offset{0}
+        scroll_offset{0}, dirty_rows{0}, drawn_begin{0}, drawn_end{0}, item_allocator{nullptr}
     {
         current_item = items.end();
         max_visisble_items = view_rect.height / menu_font.height;
+        assert(max_visisble_items <= 32); // dirty_rows has one bit per row
     }
     virtual ~Menu();
     virtual void draw();
+    virtual bool needs_render() { return draw_pending || dirty_rows != 0; }
+
+    /**
+     * @brief draw the whole menu if invalidate() was called; otherwise,
+     * redraw only the rows of items that changed
+     */
+    virtual void render();
     virtual void entry() {
         has_focus = true;
         for (auto& item: items) {
             item->exit();
         }
+        drawn_begin = drawn_end = 0;
     }
     virtual void exit() {
         has_focus = false;
         for (auto& item: items) {
             item->exit();
         }
+        drawn_begin = drawn_end = 0;
     }
     virtual void add_menu_item(Menu_item* item_) {
+        item_->set_owner(this, static_cast<int>(items.size()), item_changed);
         items.push_back(item_);
+        if (!item_->is_hidden())
+            visible_idx.push_back(static_cast<int>(items.size())-1);
         current_item = items.begin();
         scroll_offset = 0;
     }
 
+    /**
+     * @brief Set the allocator new_menu_item() uses
+     *
+     * @param item_allocator_ the allocator, or nullptr to allocate new items
+     * from the heap. The allocator must not be destroyed before this Menu.
+     */
+    void set_item_allocator(Menu_item_allocator* item_allocator_) { item_allocator = item_allocator_; }
+
+    Menu_item_allocator* get_item_allocator() { return item_allocator; }
+
+    /**
+     * @brief construct a new Menu_item object of class T from the item
+     * allocator, or from the heap if this Menu has no item allocator
+     *
+     * @param args_ the arguments for the T class constructor
+     * @return a pointer to the new object or nullptr if the item allocator
+     * has no storage left for it
+     * @note this function does not add the new object to the menu
+     */
+    template<typename T, typename... Args>
+    T* new_menu_item(Args&&... args_)
+    {
+        if (item_allocator == nullptr)
+            return new T(std::forward<Args>(args_)...);
+        void* storage = item_allocator->allocate(sizeof(T));
+        if (storage == nullptr)
+            return nullptr;
+        return new (storage) T(std::forward<Args>(args_)...);
+    }
+
     /**
      * @brief free the memory allocated to the current menu item
      * and then erase the pointer to the item from the menu's items list.
      *
      * @note do not call this function unless the item being erased was
-     * allocated by new.
+     * allocated by new or by new_menu_item().
      */
     virtual void erase_current_item()
     {
         int idx = get_current_item_idx(); // keep offset of the current menu item
-        delete (*current_item); // free the menu item that was dynamically allocated
+        delete_menu_item(*current_item); // free the menu item that was dynamically allocated
         items.erase(current_item); // remove the current item from the memu
+        renumber_items(idx, false);
         // update the menu's current item
         if (idx < static_cast<int>(items.size())) {
             current_item = items.begin()+idx;
@@ -98,9 +148,12 @@ public:
     virtual void clear()
     {
         for (auto& item:items)
-            delete item;
+            delete_menu_item(item);
         items.clear();
+        visible_idx.clear();
         current_item = items.end();
+        scroll_offset = 0;
+        drawn_begin = drawn_end = 0;
     }
 
     virtual void insert_menu_item_before_current(Menu_item * item_)
@@ -112,9 +165,11 @@ public:
         }
         else {
             (*current_item)->set_highlighted(false);
+            item_->set_owner(this, idx, item_changed);
             items.insert(current_item, item_);
             // inserting invalidates the iterator
             current_item = items.begin()+idx; // The inserted item is now current_item
+            renumber_items(idx, true);
         }
     }
     virtual const char* get_menu_item_text(int idx) {if (idx >=0 && idx < (int)items.size()) return items[idx]->get_text(); return nullptr; }
@@ -133,6 +188,11 @@ public:
 
     size_t get_num_items() {return items.size(); }
 
+    /**
+     * @brief Get the number of menu items that are not hidden
+     */
+    size_t get_num_visible_items() {return visible_idx.size(); }
+
     /**
      * @brief Get the current item idx
      * 
@@ -154,6 +214,72 @@ public:
         return *current_item;
     }
 protected:
+    /**
+     * @brief destroy a Menu_item object and free its memory to the
+     * item allocator if it came from there, or to the heap otherwise
+     */
+    void delete_menu_item(Menu_item* item_);
+
+    /**
+     * @brief make next_item the current item and update the display.
+     *
+     * If the scroll_offset has to change, then every row moves and the
+     * whole menu is invalidated. Otherwise, only the previously highlighted
+     * row and the newly highlighted row are marked dirty.
+     *
+     * @param next_item the new current item; it must not be hidden
+     */
+    void move_current_item(std::vector<Menu_item*>::iterator next_item);
+
+    /**
+     * @brief flag the row that shows item_ as needing a redraw.
+     *
+     * Has no effect if item_ is hidden or scrolled out of the visible window.
+     */
+    void mark_row_dirty(std::vector<Menu_item*>::iterator item_);
+
+    /**
+     * @brief redraw the rows flagged by mark_row_dirty() and then clear the flags
+     */
+    void redraw_dirty_rows();
+
+    /**
+     * @brief find the position of an item in the visible_idx list
+     *
+     * @param idx the index of the item in the items list
+     * @return the number of items before idx that are not hidden, which
+     * is also the visible_idx position of idx if the item is not hidden
+     */
+    int get_visible_pos(int idx);
+
+    /**
+     * @brief make the item at visible_idx[row] visible in the window
+     * by changing scroll_offset if required
+     *
+     * @param row the position in the visible_idx list
+     */
+    void scroll_to_visible_pos(int row);
+
+    /**
+     * @brief bring visible_idx and the index each item holds up to date
+     * after inserting or erasing items[first_idx]. Also make sure the next
+     * draw() calls exit() on every item that might have been drawn.
+     *
+     * @param first_idx the index of the item inserted or erased
+     * @param inserted true if items[first_idx] was inserted, false if erased
+     */
+    void renumber_items(int first_idx, bool inserted);
+
+    /**
+     * @brief Menu_item::set_hidden() and Menu_item::invalidate() call this
+     * function when the hidden state or the appearance of an item changes
+     *
+     * @param context a pointer to this Menu object
+     * @param idx the index of the item in the items list
+     * @param change what changed
+     */
+    static void item_changed(void* context, int idx, Menu_item::Change change);
+
     const Mono_mono_font& menu_font;
     std::vector<Menu_item*> items;
     std::vector<Menu_item*>::iterator current_item;
@@ -165,5 +291,14 @@ protected:
      * then need to increment scroll_offset and redraw.
      */
     int scroll_offset; 
+    uint32_t dirty_rows; //!< bit n set means the nth row of the window needs a redraw
+    /* visible_idx is the sorted list of the indices of the items that are not hidden.
+     * The window shows the max_visisble_items entries starting with the first
+     * entry >= scroll_offset.
+     */
+    std::vector<int> visible_idx;
+    int drawn_begin; //!< the index of the first item the last draw() may have drawn
+    int drawn_end; //!< one past the index of the last item the last draw() may have drawn
+    Menu_item_allocator* item_allocator; //!< if not nullptr, new_menu_item() allocates from here
 };
 }
\ No newline at end of file
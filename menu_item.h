@@ -29,13 +29,89 @@
 #include "view.h"
 #include "mono_graphics_lib.h"
 namespace rppicomidi {
+/**
+ * @brief the label text for a Menu_item
+ *
+ * A const char* converts to a Menu_item_text that tells the Menu_item to
+ * copy the text to the buffer inside the item, so the text may be in a
+ * temporary buffer. The fixed() functions make a Menu_item_text that tells
+ * the Menu_item to point to the text instead. Use fixed() for string
+ * literals, which stay in flash, to skip the copy and the strlen().
+ */
+class Menu_item_text
+{
+public:
+    Menu_item_text(const char* str_) : str{str_}, len{strlen(str_)}, is_fixed{false} {}
+
+    /**
+     * @brief make a Menu_item_text that points to a string literal; the
+     * length is computed at compile time
+     */
+    template<size_t N>
+    static constexpr Menu_item_text fixed(const char (&str_)[N]) { return Menu_item_text{str_, N-1, true}; }
+
+    /**
+     * @brief make a Menu_item_text that points to a '\0' terminated string
+     * that is not changed or freed while a Menu_item uses it
+     *
+     * @param str_ the string
+     * @param len_ strlen(str_)
+     */
+    static constexpr Menu_item_text fixed(const char* str_, size_t len_) { return Menu_item_text{str_, len_, true}; }
+
+    const char* const str;
+    const size_t len;
+    const bool is_fixed;    //!< true to point to str, false to copy it
+private:
+    constexpr Menu_item_text(const char* str_, size_t len_, bool is_fixed_) : str{str_}, len{len_}, is_fixed{is_fixed_} {}
+};
+
 class Menu_item
 {
 public:
+    /// what changed when a Menu_item calls its owner's item_changed_cb
+    enum Change {
+        hidden_changed,     //!< set_hidden() changed the hidden state of the item
+        appearance_changed, //!< the item needs to be redrawn
+    };
     Menu_item() = delete;
-    Menu_item(const char* text_, Mono_graphics& screen_, const Mono_mono_font& font_) : screen{screen_}, font{font_},
-        highlighted{false}, hidden{false}, disabled{false}, last_draw_y{-1} { strncpy(text, text_, max_text_len); text[max_text_len] = '\0'; }
-    virtual ~Menu_item() = default;
+    Menu_item(const Menu_item&) = delete;
+    Menu_item& operator=(const Menu_item&) = delete;
+    Menu_item(const Menu_item_text& text_, Mono_graphics& screen_, const Mono_mono_font& font_) : screen{screen_}, font{font_},
+        highlighted{false}, hidden{false}, disabled{false}, text{""}, text_len{0}, last_draw_y{-1},
+        owner{nullptr}, owner_idx{-1}, item_changed_cb{nullptr}
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        , bitmap_cache{nullptr}, bitmap_cache_width{0}, bitmap_cache_enabled{false}, bitmap_cache_valid{false}
+#endif
+        { set_text(text_); }
+    /**
+     * @brief move an item, for example into a std::vector
+     */
+    Menu_item(Menu_item&& other) : screen{other.screen}, font{other.font},
+        highlighted{other.highlighted}, hidden{other.hidden}, disabled{other.disabled},
+        text{other.text}, text_len{other.text_len}, last_draw_y{other.last_draw_y},
+        owner{other.owner}, owner_idx{other.owner_idx}, item_changed_cb{other.item_changed_cb}
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        , bitmap_cache{other.bitmap_cache}, bitmap_cache_width{other.bitmap_cache_width},
+        bitmap_cache_enabled{other.bitmap_cache_enabled}, bitmap_cache_valid{other.bitmap_cache_valid}
+#endif
+    {
+        if (other.text == other.text_copy) {
+            memcpy(text_copy, other.text_copy, sizeof(text_copy));
+            text = text_copy;
+        }
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        other.bitmap_cache = nullptr;
+        other.bitmap_cache_width = 0;
+        other.bitmap_cache_valid = false;
+#endif
+    }
+    virtual ~Menu_item()
+    {
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        delete[] bitmap_cache;
+#endif
+    }
 
     /**
      * @brief draw the view to the screen
@@ -59,10 +135,59 @@ public:
             return;
         if (is_hidden())
             return;
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        if (bitmap_cache_enabled) {
+            redraw_from_bitmap_cache();
+            return;
+        }
+#endif
         if (is_highlighted())
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
+            screen.draw_string(font, 0, last_draw_y, text, text_len, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
+        else
+            screen.draw_string(font, 0, last_draw_y, text, text_len, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+    }
+
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+    /**
+     * @brief keep a copy of the pixels of the item's row so that redraw()
+     * copies them to the screen instead of drawing the text again
+     *
+     * The cache holds the row as it looks when the item is not highlighted.
+     * The highlighted row is the same bitmap drawn inverted. The cache
+     * uses text_len*font.width*((font.height+7)/8) bytes of heap, and
+     * redraw() fills it again after the text changes. Only items that draw
+     * with Menu_item::redraw() use the cache. The function, and the cache
+     * members, exist only if the Mono_graphics class defines
+     * MONO_GRAPHICS_HAS_BITMAP_COPY.
+     *
+     * @param enabled true to use the cache, false to free it
+     */
+    void set_bitmap_cache_enabled(bool enabled)
+    {
+        bitmap_cache_enabled = enabled;
+        if (!enabled) {
+            delete[] bitmap_cache;
+            bitmap_cache = nullptr;
+            bitmap_cache_width = 0;
+            bitmap_cache_valid = false;
+        }
+    }
+#endif
+
+    /**
+     * @brief call this function instead of redraw() when something that
+     * changes how the item looks has changed.
+     *
+     * If this item belongs to a Menu, the Menu redraws the item's row on its
+     * next render(), which happens right away unless View::is_render_deferred().
+     * Otherwise, this function calls redraw().
+     */
+    void invalidate()
+    {
+        if (item_changed_cb)
+            item_changed_cb(owner, owner_idx, appearance_changed);
         else
-            screen.draw_string(font, 0, last_draw_y, text, strlen(text), Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+            redraw();
     }
 
     /**
@@ -114,20 +239,127 @@ public:
     virtual void on_right(uint32_t delta, bool is_shifted) {(void)delta; (void)is_shifted;}
     virtual void set_highlighted(bool highlighted_) {highlighted = highlighted_; }
     virtual bool is_highlighted() {return highlighted; }
-    virtual void set_hidden(bool hidden_) {hidden = hidden_; }
+    virtual void set_hidden(bool hidden_)
+    {
+        if (hidden != hidden_) {
+            hidden = hidden_;
+            if (item_changed_cb)
+                item_changed_cb(owner, owner_idx, hidden_changed);
+        }
+    }
     virtual bool is_hidden()  {return hidden; }
     virtual void set_disabled(bool disabled_) {disabled = disabled_; }
     virtual bool is_disabled()  {return disabled; }
+    bool is_drawn() const {return last_draw_y >= 0; }
     virtual const char* get_text() {return text; }
-    virtual void set_text(const char* new_text) {strncpy(text, new_text, max_text_len); text[max_text_len] = '\0'; }
+
+    /**
+     * @brief copy new_text to the buffer inside the item
+     *
+     * The text is truncated to max_text_len characters.
+     */
+    virtual void set_text(const char* new_text)
+    {
+        uint8_t len = 0;
+        while (len < max_text_len && new_text[len] != '\0')
+            ++len;
+        // new_text may be get_text()
+        memmove(text_copy, new_text, len);
+        text_copy[len] = '\0';
+        text = text_copy;
+        text_len = len;
+        text_changed();
+    }
+
+    /**
+     * @brief copy the new text or point to it, depending on how new_text was made
+     */
+    void set_text(const Menu_item_text& new_text)
+    {
+        if (new_text.is_fixed) {
+            text = new_text.str;
+            text_len = new_text.len < max_text_len ? new_text.len : max_text_len;
+            text_changed();
+        }
+        else {
+            Menu_item::set_text(new_text.str);
+        }
+    }
+
+    /**
+     * @brief the Menu that holds this item calls this function so it can
+     * keep track of which items are hidden and which rows need a redraw
+     * without polling every item.
+     *
+     * @param owner_ the context pointer to pass to item_changed_cb_
+     * @param owner_idx_ the index of this item in the owner's item list
+     * @param item_changed_cb_ called after set_hidden() changes the hidden state
+     * or after invalidate() is called
+     */
+    void set_owner(void* owner_, int owner_idx_, void (*item_changed_cb_)(void* owner, int owner_idx, Change change))
+    {
+        owner = owner_;
+        owner_idx = owner_idx_;
+        item_changed_cb = item_changed_cb_;
+    }
+
+    /**
+     * @brief the owner calls this function when inserting or erasing
+     * other items changes the index of this item
+     */
+    void set_owner_idx(int owner_idx_) { owner_idx = owner_idx_; }
 protected:
     Mono_graphics& screen;
     const Mono_mono_font& font;
     bool highlighted;
     bool hidden;
     bool disabled;
+    /**
+     * @brief the set_text() functions call this function after the text changes
+     */
+    void text_changed()
+    {
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+        bitmap_cache_valid = false;
+#endif
+    }
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+    /**
+     * @brief draw the item from the bitmap cache; fill the cache first if
+     * the text changed since the last time
+     */
+    void redraw_from_bitmap_cache()
+    {
+        uint8_t width = text_len*font.width < screen.get_screen_width() ? text_len*font.width : screen.get_screen_width();
+        if (!bitmap_cache_valid) {
+            if (width > bitmap_cache_width) {
+                delete[] bitmap_cache;
+                bitmap_cache = new uint8_t[width * ((font.height + 7) / 8)];
+                bitmap_cache_width = width;
+            }
+            screen.draw_string(font, 0, last_draw_y, text, text_len, Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+            screen.capture_bitmap(0, last_draw_y, width, font.height, bitmap_cache);
+            // a row that is partly off the screen does not capture all of its pixels
+            bitmap_cache_valid = last_draw_y + font.height <= screen.get_screen_height();
+            if (!is_highlighted())
+                return;
+        }
+        screen.draw_bitmap(0, last_draw_y, width, font.height, bitmap_cache, is_highlighted());
+    }
+#endif
     static const uint8_t max_text_len = 21;
-    char text[max_text_len+1];
+    const char* text;       //!< points to text_copy or to fixed text
+    uint8_t text_len;       //!< the number of characters of text to draw, so redraw() does not have to count them every time
+    char text_copy[max_text_len+1]; //!< the copy of text that is not fixed
     int8_t last_draw_y;  // if < 0, never drawn before.
+    void* owner;
+    int owner_idx;
+    void (*item_changed_cb)(void* owner, int owner_idx, Change change);
+#ifdef MONO_GRAPHICS_HAS_BITMAP_COPY
+    uint8_t* bitmap_cache;      //!< the pixels of the row when it is not highlighted, or nullptr
+    uint8_t bitmap_cache_width; //!< the width in pixels the bitmap_cache storage holds
+    bool bitmap_cache_enabled;
+    bool bitmap_cache_valid;    //!< true if bitmap_cache holds the pixels for the current text
+#endif
 };
 }
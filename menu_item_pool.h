@@ -0,0 +1,144 @@
+/**
+ * @file menu_item_pool.h
+ * @brief these classes describe a fixed size block allocator for Menu_item
+ * objects.
+ *
+ * Menus that get rebuilt while the program runs, for example when a
+ * USB device is plugged in, allocate and free many Menu_item objects
+ * over time. Allocating them from a Menu_item_pool instead of from the
+ * heap keeps the heap from fragmenting. Pass the pool to the Menu with
+ * Menu::set_item_allocator() and create the items with
+ * Menu::new_menu_item().
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+namespace rppicomidi
+{
+class Menu_item_allocator
+{
+public:
+    virtual ~Menu_item_allocator() = default;
+
+    /**
+     * @brief allocate storage for one Menu_item object
+     *
+     * @param nbytes the size of the object
+     * @return a pointer to the storage or nullptr if there is no storage
+     * block free or if nbytes is too large for a storage block
+     */
+    virtual void* allocate(size_t nbytes) = 0;
+
+    /**
+     * @brief return storage allocate() returned to the allocator
+     *
+     * @param ptr the pointer allocate() returned
+     */
+    virtual void deallocate(void* ptr) = 0;
+
+    /**
+     * @brief check if ptr points to storage that belongs to this allocator
+     */
+    virtual bool owns(const void* ptr) const = 0;
+
+    /**
+     * @brief Get the number of storage blocks currently allocated
+     */
+    virtual size_t get_num_allocated() const = 0;
+
+    /**
+     * @brief Get the maximum number of storage blocks that were allocated at the
+     * same time since the allocator was created. Use this to size the allocator.
+     */
+    virtual size_t get_high_water_mark() const = 0;
+};
+
+/**
+ * @brief a Menu_item_allocator with num_blocks_ storage blocks of block_size_ bytes
+ * each. The storage is part of the object, so a statically allocated
+ * Menu_item_pool never touches the heap.
+ *
+ * @tparam block_size_ the size of the largest Menu_item class the pool must hold
+ * @tparam num_blocks_ the maximum number of Menu_item objects the pool can hold
+ */
+template<size_t block_size_, size_t num_blocks_>
+class Menu_item_pool : public Menu_item_allocator
+{
+public:
+    Menu_item_pool() : free_list{nullptr}, num_allocated{0}, high_water_mark{0}
+    {
+        for (size_t idx = num_blocks_; idx > 0; idx--) {
+            Free_block* block = reinterpret_cast<Free_block*>(storage + (idx-1)*block_size);
+            block->next = free_list;
+            free_list = block;
+        }
+    }
+    Menu_item_pool(const Menu_item_pool&) = delete;
+    Menu_item_pool& operator=(const Menu_item_pool&) = delete;
+
+    void* allocate(size_t nbytes) final
+    {
+        if (nbytes > block_size || free_list == nullptr)
+            return nullptr;
+        Free_block* block = free_list;
+        free_list = block->next;
+        if (++num_allocated > high_water_mark)
+            high_water_mark = num_allocated;
+        return block;
+    }
+
+    void deallocate(void* ptr) final
+    {
+        if (ptr == nullptr)
+            return;
+        Free_block* block = reinterpret_cast<Free_block*>(ptr);
+        block->next = free_list;
+        free_list = block;
+        --num_allocated;
+    }
+
+    bool owns(const void* ptr) const final
+    {
+        auto addr = reinterpret_cast<const uint8_t*>(ptr);
+        return addr >= storage && addr < storage + sizeof(storage);
+    }
+
+    size_t get_num_allocated() const final { return num_allocated; }
+    size_t get_high_water_mark() const final { return high_water_mark; }
+private:
+    struct Free_block {
+        Free_block* next;
+    };
+    static constexpr size_t block_align = alignof(std::max_align_t);
+    // every block must hold a Free_block; round the block size up so every
+    // block is aligned for any Menu_item class
+    static constexpr size_t min_block_size = block_size_ < sizeof(Free_block) ? sizeof(Free_block) : block_size_;
+    static constexpr size_t block_size = (min_block_size + block_align - 1) / block_align * block_align;
+    alignas(std::max_align_t) uint8_t storage[block_size * num_blocks_];
+    Free_block* free_list;
+    size_t num_allocated;
+    size_t high_water_mark;
+};
+}
@@ -85,25 +85,25 @@ void rppicomidi::Nav_buttons::poll()
                     uint8_t button = bit + 6;
                     switch (button) {
                     case BUTTON_UP:
-                        view_manager.on_increment(1, is_shifted);
+                        view_manager.post_event(Ui_event{Ui_event::increment, 1, is_shifted}, View_manager::button_input);
                         break;
                     case BUTTON_DOWN:
-                        view_manager.on_decrement(1, is_shifted);
+                        view_manager.post_event(Ui_event{Ui_event::decrement, 1, is_shifted}, View_manager::button_input);
                         break;
                     case BUTTON_LEFT:
-                        view_manager.on_left(1, is_shifted);
+                        view_manager.post_event(Ui_event{Ui_event::left, 1, is_shifted}, View_manager::button_input);
                         break;
                     case BUTTON_RIGHT:
-                        view_manager.on_right(1, is_shifted);
+                        view_manager.post_event(Ui_event{Ui_event::right, 1, is_shifted}, View_manager::button_input);
                         break;
                     case BUTTON_BACK:
                         if (is_shifted)
-                            view_manager.go_home();
+                            view_manager.post_event(Ui_event{Ui_event::home}, View_manager::button_input);
                         else
-                            view_manager.on_back();
+                            view_manager.post_event(Ui_event{Ui_event::back}, View_manager::button_input);
                         break;
                     case BUTTON_ENTER:
-                        view_manager.on_select();
+                        view_manager.post_event(Ui_event{Ui_event::select}, View_manager::button_input);
                         break;
                     default:
                         break;
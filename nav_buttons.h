@@ -31,6 +31,7 @@
  * SOFTWARE.
  */
 #pragma once
+#include "pico/stdlib.h"
 #include "view_manager.h"
 // Button GP number default definitions
 #ifndef BUTTON_UP
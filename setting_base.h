@@ -0,0 +1,145 @@
+/**
+ * @file setting_base.h
+ *
+ * This class is the interface all Setting_* classes have in common.
+ * A Setting_list uses it to save and load a list of settings of different
+ * types in the JSON format or in the binary format.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "parson.h"
+#include "setting_binary.h"
+#include "json_writer.h"
+#include "json_reader.h"
+namespace rppicomidi
+{
+class Setting_base
+{
+public:
+    virtual ~Setting_base()=default;
+
+    /**
+     * @brief Get the name of this setting
+     */
+    virtual const char* get_name()=0;
+
+    /**
+     * @brief Set the setting value to default
+     */
+    virtual void set_default()=0;
+
+    /**
+     * @brief add the setting name and value to the JSON root object
+     */
+    virtual void serialize(JSON_Object *root_object)=0;
+
+    /**
+     * @brief write the setting name and value as the next member of the
+     * JSON object the writer is writing
+     */
+    virtual void serialize(Json_writer& writer)=0;
+
+    /**
+     * @brief get the value of the setting with the name of this object from
+     * the JSON root object
+     *
+     * @return false if the setting name was not found or the value is not legal
+     */
+    virtual bool deserialize(JSON_Object *root_object)=0;
+
+    /**
+     * @brief get the value from the events a Json_reader sends for the
+     * value of the member with the name of this object
+     *
+     * @param event the event; its depth is 0 for the value itself, 1 for the
+     * values in it, and so on
+     * @return false if the event is wrong for this setting or the value is
+     * not legal; the setting gets no more events for the value then
+     */
+    virtual bool deserialize(const Json_event& event)=0;
+
+    /**
+     * @brief write the setting as one record of the binary settings format
+     */
+    virtual void serialize(Setting_binary_writer& writer)=0;
+
+    /**
+     * @brief get the value from the payload of a binary settings record
+     * with the name of this object
+     *
+     * @param type the record type
+     * @param payload the record payload
+     * @return false if the type is wrong for this setting, the payload is not
+     * well formed, or the value is not legal
+     */
+    virtual bool deserialize(Setting_binary_type type, Setting_binary_reader& payload)=0;
+};
+
+/**
+ * @brief check that static_cast<T>(value) does not wrap or overflow, so
+ * the setting can check the range of the converted value
+ *
+ * @param value a number from JSON text
+ * @return false if value is NaN or outside the range of T; an integral T
+ * accepts the fractional values the cast truncates to a value of T
+ */
+template<typename T>
+bool setting_number_fits(double value)
+{
+    if constexpr (std::is_integral<T>::value) {
+        // 2^digits is exact in a double, unlike the maximum value of a 64-bit T
+        const double limit = std::ldexp(1.0, std::numeric_limits<T>::digits);
+        return value < limit && (std::is_signed<T>::value ? value >= -limit : value > -1.0);
+    }
+    else {
+        return value >= -static_cast<double>(std::numeric_limits<T>::max()) &&
+            value <= static_cast<double>(std::numeric_limits<T>::max());
+    }
+}
+
+/**
+ * @brief check that static_cast<T>(value) gives back the integral value of
+ * type T that was written to the binary settings format as value
+ *
+ * @param value a zigzag varint from a binary settings record
+ */
+template<typename T>
+bool setting_integer_fits(int64_t value)
+{
+    if constexpr (std::is_unsigned<T>::value && std::numeric_limits<T>::digits >= 64) {
+        // values above INT64_MAX were written as negative numbers
+        return true;
+    }
+    else if constexpr (std::is_unsigned<T>::value) {
+        return value >= 0 && static_cast<uint64_t>(value) <= std::numeric_limits<T>::max();
+    }
+    else {
+        return value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max();
+    }
+}
+}
@@ -33,20 +33,235 @@
 #include <cstdint>
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <cassert>
 #include "parson.h"
+#include "setting_base.h"
 namespace rppicomidi
 {
+/**
+ * @brief an index that finds the first pair in a Setting_bimap array
+ * with a given value in either element of the pair.
+ *
+ * For 1-byte types, the index is a lookup table with one entry per
+ * possible value, so find() is one array read. For wider types, the
+ * index is an array of pair indices sorted by value, and find() is a
+ * binary search.
+ *
+ * The Setting_bimap keeps the index up to date as the pairs change:
+ * it calls remove() before an element changes or a pair leaves the
+ * array, and add() after an element changes or a pair joins the array.
+ * None of these functions sorts the whole array, and with storage from
+ * set_storage(), none of them uses the heap.
+ */
+template<typename T, bool lookup_table = (sizeof(T) == 1)>
+class Setting_bimap_index
+{
+public:
+    Setting_bimap_index() { clear(); }
+
+    /**
+     * @brief Get the number of uint16_t a fixed size bimap array of max_pairs
+     * pairs must pass to set_storage()
+     */
+    static constexpr size_t get_storage_size(size_t) { return 0; }
+
+    /**
+     * @brief use storage for up to max_pairs pairs instead of the heap
+     */
+    void set_storage(uint16_t*, size_t max_pairs) { assert(max_pairs <= INT16_MAX); (void)max_pairs; }
+
+    /**
+     * @brief make the index empty
+     */
+    void clear()
+    {
+        std::fill(&first_idx[0][0], &first_idx[0][0] + 2*256, -1);
+    }
+
+    /**
+     * @brief add element element_idx of pair idx to the index
+     *
+     * @param pairs the bimap array after the element changed or the pair was added
+     */
+    void add(const std::array<T,2>* pairs, size_t, size_t idx, size_t element_idx)
+    {
+        assert(idx < INT16_MAX);
+        int16_t& first = first_idx[element_idx][static_cast<uint8_t>(pairs[idx][element_idx])];
+        if (first < 0 || first > static_cast<int16_t>(idx))
+            first = static_cast<int16_t>(idx);
+    }
+
+    /**
+     * @brief remove element element_idx of pair idx from the index
+     *
+     * @param pairs the bimap array before the element changes or the pair is erased
+     * @param npairs the number of pairs in the bimap array
+     */
+    void remove(const std::array<T,2>* pairs, size_t npairs, size_t idx, size_t element_idx)
+    {
+        T value = pairs[idx][element_idx];
+        int16_t& first = first_idx[element_idx][static_cast<uint8_t>(value)];
+        if (first == static_cast<int16_t>(idx)) {
+            // the next pair with the value, if any, is now the first
+            first = -1;
+            for (size_t next = idx + 1; next < npairs; next++) {
+                if (pairs[next][element_idx] == value) {
+                    first = static_cast<int16_t>(next);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief renumber the pairs that follow pair idx when pair idx is erased;
+     * call remove() for both elements of pair idx first
+     */
+    void erase(size_t idx)
+    {
+        for (auto& first: first_idx[0]) {
+            if (first > static_cast<int16_t>(idx))
+                --first;
+        }
+        for (auto& first: first_idx[1]) {
+            if (first > static_cast<int16_t>(idx))
+                --first;
+        }
+    }
+
+    /**
+     * @brief find the index of the first pair with element element_idx equal to value
+     *
+     * @return the index or -1 if no pair has the value
+     */
+    int find(const std::array<T,2>*, T value, size_t element_idx) const
+    {
+        return first_idx[element_idx][static_cast<uint8_t>(value)];
+    }
+private:
+    int16_t first_idx[2][256];  //!< first_idx[element_idx][value] is the first pair index with the value or -1
+};
+
+template<typename T>
+class Setting_bimap_index<T, false>
+{
+public:
+    Setting_bimap_index() : sorted{nullptr, nullptr}, nsorted{0, 0}, max_sorted{0} {}
+
+    static constexpr size_t get_storage_size(size_t max_pairs) { return 2 * max_pairs; }
+
+    void set_storage(uint16_t* storage, size_t max_pairs)
+    {
+        assert(max_pairs <= UINT16_MAX);
+        sorted[0] = storage;
+        sorted[1] = storage + max_pairs;
+        max_sorted = max_pairs;
+    }
+
+    void clear()
+    {
+        for (size_t element_idx = 0; element_idx < 2; element_idx++) {
+            nsorted[element_idx] = 0;
+            heap_sorted[element_idx].clear();
+        }
+    }
+
+    void add(const std::array<T,2>* pairs, size_t, size_t idx, size_t element_idx)
+    {
+        assert(idx < UINT16_MAX);
+        if (max_sorted == 0) {
+            heap_sorted[element_idx].push_back(0);
+            sorted[element_idx] = heap_sorted[element_idx].data();
+        }
+        assert(max_sorted == 0 || nsorted[element_idx] < max_sorted);
+        uint16_t* first = sorted[element_idx];
+        uint16_t* last = first + nsorted[element_idx];
+        // one insertion step keeps the indices sorted by value, then by index
+        uint16_t* pos = std::lower_bound(first, last, idx, [pairs, element_idx](uint16_t lhs, size_t rhs) {
+            return is_before(pairs, element_idx, lhs, rhs);
+        });
+        std::copy_backward(pos, last, last + 1);
+        *pos = static_cast<uint16_t>(idx);
+        ++nsorted[element_idx];
+    }
+
+    void remove(const std::array<T,2>* pairs, size_t, size_t idx, size_t element_idx)
+    {
+        uint16_t* first = sorted[element_idx];
+        uint16_t* last = first + nsorted[element_idx];
+        uint16_t* pos = std::lower_bound(first, last, idx, [pairs, element_idx](uint16_t lhs, size_t rhs) {
+            return is_before(pairs, element_idx, lhs, rhs);
+        });
+        assert(pos != last && *pos == idx);
+        std::copy(pos + 1, last, pos);
+        --nsorted[element_idx];
+        if (max_sorted == 0)
+            heap_sorted[element_idx].pop_back();
+    }
+
+    void erase(size_t idx)
+    {
+        for (size_t element_idx = 0; element_idx < 2; element_idx++) {
+            for (size_t pos = 0; pos < nsorted[element_idx]; pos++) {
+                if (sorted[element_idx][pos] > idx)
+                    --sorted[element_idx][pos];
+            }
+        }
+    }
+
+    int find(const std::array<T,2>* pairs, T value, size_t element_idx) const
+    {
+        const uint16_t* first = sorted[element_idx];
+        const uint16_t* last = first + nsorted[element_idx];
+        const uint16_t* pos = std::lower_bound(first, last, value, [pairs, element_idx](uint16_t idx, T val) {
+            return pairs[idx][element_idx] < val;
+        });
+        if (pos != last && pairs[*pos][element_idx] == value)
+            return *pos;
+        return -1;
+    }
+private:
+    /// the index order: by value, and pairs with equal values by index
+    static bool is_before(const std::array<T,2>* pairs, size_t element_idx, size_t lhs, size_t rhs)
+    {
+        T lhs_value = pairs[lhs][element_idx];
+        T rhs_value = pairs[rhs][element_idx];
+        return lhs_value < rhs_value || (lhs_value == rhs_value && lhs < rhs);
+    }
+
+    uint16_t* sorted[2];    //!< sorted[element_idx] holds the pair indices sorted by that element
+    size_t nsorted[2];      //!< the number of pair indices in sorted[element_idx]
+    size_t max_sorted;      //!< the size of the storage from set_storage(), or 0 to use heap_sorted
+    std::vector<uint16_t> heap_sorted[2];
+};
+
 template<typename T, typename = typename std::enable_if<std::is_integral<T>::value, T>::type>
-class Setting_bimap
+class Setting_bimap : public Setting_base
 {
 public:
+    /**
+     * @brief both values of one bi-directional mapping and the value that
+     * marks a value as invalid
+     */
+    struct Pair {
+        T first;    //!< the forward map key
+        T second;   //!< the forward map value
+        T invalid;  //!< get_max()+1
+    };
+
+    /**
+     * @brief Construct a new Setting_bimap object that stores the pairs in a
+     * heap allocated array that grows as needed
+     */
     Setting_bimap(const char* name_, T minval_, T maxval_) :
-        name{name_}, minval{minval_}, maxval{maxval_}
+        name{name_}, minval{minval_}, maxval{maxval_}, pairs{nullptr}, npairs{0}, max_pairs{0}
     {
         set_default();
     }
     Setting_bimap()=delete;
+    Setting_bimap(const Setting_bimap&)=delete;
+    Setting_bimap& operator=(const Setting_bimap&)=delete;
 
     virtual ~Setting_bimap()=default;
     /**
@@ -70,30 +285,34 @@ public:
     /**
      * @brief Set the setting value to default
      */
-    void set_default() { bimap.clear(); }
+    void set_default() { npairs = 0; heap_pairs.clear(); index.clear(); }
 
     /**
      * @brief find the index of the first instance of the key in the bimap array
      *
+     * The function looks first up in an index of the array that the
+     * functions that change the array keep up to date, so it takes the same
+     * time no matter how many pairs the array holds (or, for types wider
+     * than one byte, logarithmic time). It does not change the object.
+     *
      * @param first is the value to remap
      * @param i_first is 0 for forward map, 1 for reverse map
      * @return -1 if first was not found, otherwise return the index where first was found
      */
-    int find(T first, size_t i_first)
+    int find(T first, size_t i_first) const
     {
-        size_t idx;
-        for (idx=0; idx < bimap.size() && first != bimap[idx][i_first]; idx++) {
-        }
-        return idx < bimap.size() ? idx: -1;
+        assert(i_first < 2);
+        return index.find(pairs, first, i_first);
     }
 
     /**
-     * @brief add a new pair of numbers to the end of the bimap vector
+     * @brief add a new pair of numbers to the end of the bimap array
      * 
      * @param first the forward map key
      * @param second the forward map new value
      * @return the index where the item was added or -1 if
-     * either first or second is out of range
+     * either first or second is out of range or if the array is
+     * a fixed size array and it is full
      */
     int push_back(T first, T second)
     {
@@ -101,19 +320,39 @@ public:
             return -1;
         if (second < get_min() || second > get_max())
             return -1;
-        bimap.push_back({first,second});
-        return static_cast<int>(bimap.size())-1;
+        if (max_pairs != 0) {
+            if (npairs == max_pairs)
+                return -1;
+            pairs[npairs] = {first,second};
+        }
+        else {
+            heap_pairs.push_back({first,second});
+            pairs = heap_pairs.data();
+        }
+        ++npairs;
+        index.add(pairs, npairs, npairs - 1, 0);
+        index.add(pairs, npairs, npairs - 1, 1);
+        return static_cast<int>(npairs)-1;
     }
 
-    size_t size() {return bimap.size(); }
+    size_t size() {return npairs; }
+
+    /**
+     * @brief Get the maximum number of pairs the bimap array can hold
+     *
+     * @return 0 if the array grows as needed
+     */
+    size_t get_max_size() {return max_pairs; }
     
     bool set(size_t bimap_idx, size_t element_idx, T value)
     {
         bool result = false;
-        if (bimap_idx < bimap.size() && element_idx < 2) {
+        if (bimap_idx < npairs && element_idx < 2) {
             if (value >= get_min() && value <= get_max()) {
                 result = true;
-                bimap[bimap_idx][element_idx] = value;
+                index.remove(pairs, npairs, bimap_idx, element_idx);
+                pairs[bimap_idx][element_idx] = value;
+                index.add(pairs, npairs, bimap_idx, element_idx);
             }
         }
         return result;
@@ -122,17 +361,37 @@ public:
     T get(size_t bimap_idx, size_t element_idx)
     {
         T val = get_max()+1; // an invalid value
-        if (bimap_idx < bimap.size() && element_idx < 2) {
-            val = bimap[bimap_idx][element_idx];
+        if (bimap_idx < npairs && element_idx < 2) {
+            val = pairs[bimap_idx][element_idx];
         }
         return val;
     }
 
+    /**
+     * @brief get both values of a bi-directional mapping with one call
+     *
+     * @param bimap_idx the index of the bi-directional mapping
+     * @return the pair of values; if bimap_idx is out of range, both
+     * values are the invalid value
+     */
+    Pair get_pair(size_t bimap_idx)
+    {
+        T invalid = get_max()+1;
+        if (bimap_idx < npairs)
+            return Pair{pairs[bimap_idx][0], pairs[bimap_idx][1], invalid};
+        return Pair{invalid, invalid, invalid};
+    }
+
     void erase(size_t idx)
     {
-        if (idx < bimap.size()) {
-            auto it = bimap.begin()+idx;
-            bimap.erase(it);
+        if (idx < npairs) {
+            index.remove(pairs, npairs, idx, 0);
+            index.remove(pairs, npairs, idx, 1);
+            index.erase(idx);
+            std::copy(pairs + idx + 1, pairs + npairs, pairs + idx);
+            --npairs;
+            if (max_pairs == 0)
+                heap_pairs.pop_back();
         }
     }
 
@@ -149,8 +408,8 @@ public:
     virtual T incr(size_t bimap_idx, size_t element_idx, int delta)
     {
         T number = get_max()+1; // an invalid number
-        if (bimap_idx < bimap.size() && element_idx < 2) {
-            T prev = bimap[bimap_idx][element_idx]; // detect unsigned number wrapping
+        if (bimap_idx < npairs && element_idx < 2) {
+            T prev = pairs[bimap_idx][element_idx]; // detect unsigned number wrapping
             number = prev + delta;
             if ((number > prev && delta < 0) || number < get_min()) {
                 number = get_min();
@@ -158,7 +417,11 @@ public:
             else if ((number < prev && delta > 0) || number > get_max()) {
                 number = get_max();
             }
-            bimap[bimap_idx][element_idx] = number;
+            if (number != prev) {
+                index.remove(pairs, npairs, bimap_idx, element_idx);
+                pairs[bimap_idx][element_idx] = number;
+                index.add(pairs, npairs, bimap_idx, element_idx);
+            }
         }
         return number;
     }
@@ -187,7 +450,8 @@ public:
         assert(bimap_json_value);
         JSON_Array* bimap_json = json_value_get_array(bimap_json_value);
         assert(bimap_json);
-        for (auto& element: bimap) {
+        for (size_t idx = 0; idx < npairs; idx++) {
+            auto& element = pairs[idx];
             JSON_Value* element_json_value = json_value_init_array();
             assert(element_json_value);
             JSON_Array* element_json = json_value_get_array(element_json_value);
@@ -199,6 +463,23 @@ public:
         json_object_set_value(root_object, name, json_array_get_wrapping_value(bimap_json));
     }
 
+    /**
+     * @brief write the bimap array as the next member of the JSON object the
+     * writer is writing, without allocating any JSON values
+     */
+    virtual void serialize(Json_writer& writer)
+    {
+        writer.key(name);
+        writer.begin_array();
+        for (size_t idx = 0; idx < npairs; idx++) {
+            writer.begin_array();
+            writer.number(pairs[idx][0]);
+            writer.number(pairs[idx][1]);
+            writer.end_array();
+        }
+        writer.end_array();
+    }
+
     /**
      * @brief extract the value from the setting with the name of this object.
      * 
@@ -262,11 +543,134 @@ public:
         }
         return true;
     }
+
+    /**
+     * @brief get the bimap array from the events of a Json_reader without
+     * building a JSON array first
+     */
+    virtual bool deserialize(const Json_event& event)
+    {
+        bool success = false;
+        if (event.depth == 0) {
+            if (event.type == Json_event::begin_array)
+                set_default();
+            success = event.type == Json_event::begin_array || event.type == Json_event::end_array;
+        }
+        else if (event.depth == 1) {
+            // each pair is an array of 2 numbers
+            success = event.type == Json_event::begin_array ||
+                (event.type == Json_event::end_array && event.index == 2);
+        }
+        else if (event.depth == 2 && event.type == Json_event::number && setting_number_fits<T>(event.value)) {
+            T value = static_cast<T>(event.value);
+            if (event.index == 0)
+                success = push_back(value, value) != -1;
+            else if (event.index == 1)
+                success = set(npairs - 1, 1, value);
+        }
+        if (!success) {
+            printf("Could not parse %s from settings\r\n", name);
+            set_default();
+        }
+        return success;
+    }
+
+    /**
+     * @brief write the bimap array as one record of the binary settings
+     * format: the number of pairs as a varint followed by both values of
+     * each pair as zigzag varints
+     */
+    virtual void serialize(Setting_binary_writer& writer)
+    {
+        size_t payload_start = writer.begin_record(name, Setting_binary_type::bimap);
+        writer.put_varint(npairs);
+        for (size_t idx = 0; idx < npairs; idx++) {
+            writer.put_zigzag(static_cast<int64_t>(pairs[idx][0]));
+            writer.put_zigzag(static_cast<int64_t>(pairs[idx][1]));
+        }
+        writer.end_record(payload_start);
+    }
+
+    virtual bool deserialize(Setting_binary_type type, Setting_binary_reader& payload)
+    {
+        set_default();
+        uint64_t count;
+        if (type != Setting_binary_type::bimap || !payload.get_varint(count)) {
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        if (count > payload.get_remaining() / 2) {
+            // every pair takes at least 2 bytes
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        if (max_pairs != 0 && count > max_pairs) {
+            printf("too many pairs for setting %s\r\n", name);
+            return false;
+        }
+        if (max_pairs == 0)
+            heap_pairs.reserve(count);
+        for (uint64_t idx = 0; idx < count; idx++) {
+            int64_t element[2];
+            if (!payload.get_zigzag(element[0]) || !payload.get_zigzag(element[1])) {
+                printf("Could not parse %s from settings\r\n", name);
+                set_default();
+                return false;
+            }
+            if (!setting_integer_fits<T>(element[0]) || !setting_integer_fits<T>(element[1]) ||
+                    -1 == push_back(static_cast<T>(element[0]), static_cast<T>(element[1]))) {
+                printf("failed to push_back new bimap element\r\n");
+                set_default();
+                return false;
+            }
+        }
+        return true;
+    }
+protected:
+    /**
+     * @brief Construct a new Setting_bimap object that stores the pairs in
+     * a fixed size array; see Setting_bimap_fixed
+     *
+     * @param storage_ the array; it must exist as long as this object
+     * @param index_storage_ Setting_bimap_index<T>::get_storage_size(max_pairs_)
+     * uint16_t for the index; it must exist as long as this object
+     * @param max_pairs_ the number of pairs storage_ holds
+     */
+    Setting_bimap(const char* name_, T minval_, T maxval_, std::array<T,2>* storage_, uint16_t* index_storage_,
+        size_t max_pairs_) :
+        name{name_}, minval{minval_}, maxval{maxval_}, pairs{storage_}, npairs{0}, max_pairs{max_pairs_}
+    {
+        assert(max_pairs > 0);
+        index.set_storage(index_storage_, max_pairs);
+    }
 private:
     const char* name;
     T minval;
     T maxval;
-    std::vector<std::array<T,2>> bimap;
+    std::array<T,2>* pairs;     //!< the bimap array: heap_pairs.data() or the fixed size storage
+    size_t npairs;              //!< the number of pairs in the bimap array
+    size_t max_pairs;           //!< the size of the fixed size storage, or 0 to use heap_pairs
+    std::vector<std::array<T,2>> heap_pairs;
     T number;
+    Setting_bimap_index<T> index;   //!< finds pairs by value
+};
+
+/**
+ * @brief a Setting_bimap that stores up to max_pairs_ pairs in an array
+ * inside the object, so it never uses the heap. push_back() returns -1
+ * when the array is full. Use this for maps that get reloaded often,
+ * such as preset data; deserialize() does not allocate memory (parson
+ * still does while it parses the JSON).
+ */
+template<typename T, size_t max_pairs_>
+class Setting_bimap_fixed : public Setting_bimap<T>
+{
+public:
+    Setting_bimap_fixed(const char* name_, T minval_, T maxval_) :
+        Setting_bimap<T>{name_, minval_, maxval_, storage, index_storage.data(), max_pairs_} {}
+    Setting_bimap_fixed()=delete;
+private:
+    std::array<T,2> storage[max_pairs_];
+    std::array<uint16_t, Setting_bimap_index<T>::get_storage_size(max_pairs_)> index_storage;
 };
-}
\ No newline at end of file
+}
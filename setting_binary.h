@@ -0,0 +1,268 @@
+/**
+ * @file setting_binary.h
+ *
+ * This file implements the compact binary settings format. It stores
+ * the same settings as the JSON format in much less space, and loading
+ * it does not need a JSON parser or the heap.
+ *
+ * The data starts with the 3 bytes "RPS" and a version byte. Then there
+ * is one record per setting: the length of the name as a varint, the
+ * name, a Setting_binary_type byte, the length of the payload as a
+ * varint and the payload. A loader can skip records it does not know
+ * because every record has its length.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+namespace rppicomidi
+{
+/**
+ * @brief the record types of the binary settings format
+ */
+enum class Setting_binary_type : uint8_t {
+    integer = 0,    //!< a zigzag varint
+    real = 1,       //!< the little-endian bytes of a float or double
+    enum_index = 2, //!< a varint index into the list of enum values
+    bimap = 3,      //!< a varint number of pairs followed by 2 zigzag varints per pair
+};
+
+/**
+ * @brief write settings in the binary format to a caller supplied buffer
+ *
+ * If the buffer is too small, the writer stops writing and ok() returns
+ * false, but size() keeps counting, so size() is then the buffer size
+ * that would have been needed. Pass a nullptr buffer to only count.
+ */
+class Setting_binary_writer
+{
+public:
+    Setting_binary_writer(uint8_t* buffer_, size_t max_len_) : buffer{buffer_}, max_len{max_len_}, len{0} {}
+    Setting_binary_writer()=delete;
+
+    /**
+     * @brief write the magic bytes and the format version
+     */
+    void put_header()
+    {
+        put_bytes(magic, sizeof(magic));
+        put_byte(version);
+    }
+
+    void put_byte(uint8_t byte)
+    {
+        if (buffer && len < max_len)
+            buffer[len] = byte;
+        ++len;
+    }
+
+    void put_bytes(const void* bytes, size_t nbytes)
+    {
+        if (buffer && len + nbytes <= max_len)
+            memcpy(buffer + len, bytes, nbytes);
+        len += nbytes;
+    }
+
+    /**
+     * @brief write value 7 bits per byte, least significant bits first;
+     * every byte but the last has its most significant bit set
+     */
+    void put_varint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            put_byte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        put_byte(static_cast<uint8_t>(value));
+    }
+
+    /**
+     * @brief write value as a varint of its zigzag encoding, so small
+     * negative numbers are short too: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+     */
+    void put_zigzag(int64_t value)
+    {
+        put_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    /**
+     * @brief write the name, type and room for the payload length of a record
+     *
+     * @return the argument for end_record()
+     */
+    size_t begin_record(const char* name, Setting_binary_type type)
+    {
+        size_t name_len = strlen(name);
+        put_varint(name_len);
+        put_bytes(name, name_len);
+        put_byte(static_cast<uint8_t>(type));
+        put_byte(0); // the payload length; most payloads are shorter than 128 bytes
+        return len;
+    }
+
+    /**
+     * @brief write the payload length of the record begin_record() started
+     */
+    void end_record(size_t payload_start)
+    {
+        size_t payload_len = len - payload_start;
+        size_t extra = 0;
+        for (size_t rest = payload_len >> 7; rest != 0; rest >>= 7)
+            ++extra;
+        if (extra != 0) {
+            // make room for the longer length varint
+            if (buffer && len + extra <= max_len)
+                memmove(buffer + payload_start + extra, buffer + payload_start, payload_len);
+            len += extra;
+        }
+        size_t end = len;
+        len = payload_start - 1;
+        put_varint(payload_len);
+        len = end;
+    }
+
+    /**
+     * @brief get the number of bytes written, or the number of bytes that
+     * would have been written if the buffer were big enough
+     */
+    size_t size() const { return len; }
+
+    /**
+     * @brief return true if everything written fits in the buffer
+     */
+    bool ok() const { return buffer != nullptr && len <= max_len; }
+
+    static constexpr uint8_t magic[3] = {'R', 'P', 'S'};
+    static const uint8_t version = 1;
+private:
+    uint8_t* buffer;
+    size_t max_len;
+    size_t len;
+};
+
+/**
+ * @brief read settings in the binary format from a buffer
+ *
+ * The get functions return false if the data ends too soon or is not
+ * well formed. Strings are not copied; they point into the buffer.
+ */
+class Setting_binary_reader
+{
+public:
+    Setting_binary_reader(const uint8_t* data_, size_t len_) : data{data_}, len{len_}, pos{0} {}
+    Setting_binary_reader() : Setting_binary_reader{nullptr, 0} {}
+
+    /**
+     * @brief read and check the magic bytes and the format version
+     */
+    bool get_header()
+    {
+        uint8_t header[sizeof(Setting_binary_writer::magic) + 1];
+        return get_bytes(header, sizeof(header)) &&
+            memcmp(header, Setting_binary_writer::magic, sizeof(Setting_binary_writer::magic)) == 0 &&
+            header[sizeof(Setting_binary_writer::magic)] == Setting_binary_writer::version;
+    }
+
+    bool get_byte(uint8_t& byte)
+    {
+        if (pos >= len)
+            return false;
+        byte = data[pos++];
+        return true;
+    }
+
+    bool get_bytes(void* bytes, size_t nbytes)
+    {
+        if (len - pos < nbytes)
+            return false;
+        memcpy(bytes, data + pos, nbytes);
+        pos += nbytes;
+        return true;
+    }
+
+    bool get_varint(uint64_t& value)
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!get_byte(byte))
+                return false;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool get_zigzag(int64_t& value)
+    {
+        uint64_t zigzag;
+        if (!get_varint(zigzag))
+            return false;
+        value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        return true;
+    }
+
+    /**
+     * @brief read the next record
+     *
+     * @param name set to point to the record name in the buffer; it is not nul terminated
+     * @param name_len set to the length of the name
+     * @param type set to the record type
+     * @param payload set to a reader for the record payload
+     * @return false if there are no more records or the record is not well formed
+     */
+    bool get_record(const char*& name, size_t& name_len, Setting_binary_type& type, Setting_binary_reader& payload)
+    {
+        uint64_t nbytes;
+        uint8_t type_byte;
+        if (!get_varint(nbytes) || nbytes > len - pos)
+            return false;
+        name = reinterpret_cast<const char*>(data + pos);
+        name_len = nbytes;
+        pos += nbytes;
+        if (!get_byte(type_byte) || !get_varint(nbytes) || nbytes > len - pos)
+            return false;
+        type = static_cast<Setting_binary_type>(type_byte);
+        payload = Setting_binary_reader{data + pos, static_cast<size_t>(nbytes)};
+        pos += nbytes;
+        return true;
+    }
+
+    /**
+     * @brief get the number of bytes left to read
+     */
+    size_t get_remaining() const { return len - pos; }
+
+    /**
+     * @brief return true if all of the data has been read
+     */
+    bool at_end() const { return pos == len; }
+private:
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+};
+}
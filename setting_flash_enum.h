@@ -0,0 +1,351 @@
+/**
+ * @file setting_flash_enum.h
+ *
+ * This class implements 0-based enum values as indices into a constant
+ * table of string values that the compiler can put in flash. Like
+ * Setting_string_enum, the string value is serialized to JSON and
+ * deserialized from JSON, but no string is ever copied to the heap. The
+ * table has a perfect hash of the strings that is computed at compile
+ * time, so finding a value by its string takes two hashes, two table
+ * reads and one string compare, no matter how many values the table has.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include "parson.h"
+#include "setting_base.h"
+namespace rppicomidi
+{
+/**
+ * @brief the part of a Flash_enum_values table that does not depend on
+ * the number of values, so a Setting_flash_enum can use any table
+ */
+struct Flash_enum_table
+{
+    const char* const* values;      //!< the value strings
+    size_t nvalues;
+    const uint16_t* seeds;          //!< seeds[hash(value, 0) & bucket_mask] is the seed that gives value its own slot
+    uint32_t bucket_mask;
+    const uint8_t* slots;           //!< slots[hash(value, seed) & slot_mask] is the value index + 1, or 0 if no value hashes there
+    uint32_t slot_mask;
+
+    /**
+     * @brief hash str with the FNV-1a hash; seed changes the starting value
+     */
+    static constexpr uint32_t hash(const char* str, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;
+        for (; *str != '\0'; str++) {
+            h ^= static_cast<uint8_t>(*str);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 16);
+    }
+
+    /**
+     * @brief find the index of the value string equal to str
+     *
+     * @return the index or -1 if str is not one of the values
+     */
+    int find(const char* str) const
+    {
+        uint32_t seed = seeds[hash(str, 0) & bucket_mask];
+        uint8_t slot = slots[hash(str, seed) & slot_mask];
+        if (slot != 0 && strcmp(values[slot - 1], str) == 0)
+            return slot - 1;
+        return -1;
+    }
+};
+
+/**
+ * @brief a constant table of nvalues_ enum value strings and their perfect hash.
+ *
+ * The hash is a "hash and displace" hash: a first hash puts each value in
+ * a bucket, and each bucket has a seed for a second hash that puts each
+ * of its values in its own slot.
+ *
+ * Declare the table static constexpr so that the compiler computes the hash
+ * and puts the table in flash. For example:
+ *
+ *     static constexpr Flash_enum_values<3> mode_values{{"Off", "On", "Auto"}};
+ *     Setting_flash_enum mode{"mode", mode_values};
+ *
+ * Compiling fails if the strings are not unique; the error is a call to
+ * duplicate_value_error().
+ */
+template<size_t nvalues_>
+class Flash_enum_values
+{
+public:
+    static_assert(nvalues_ > 0 && nvalues_ < 255, "a Flash_enum_values table holds 1 to 254 values");
+
+    constexpr Flash_enum_values(const char* const (&values_)[nvalues_]) : values{}, seeds{}, slots{}
+    {
+        size_t bucket_of[nvalues_] {};
+        size_t bucket_size[nbuckets] {};
+        for (size_t idx = 0; idx < nvalues_; idx++) {
+            values[idx] = values_[idx];
+            bucket_of[idx] = Flash_enum_table::hash(values[idx], 0) & (nbuckets - 1);
+            ++bucket_size[bucket_of[idx]];
+        }
+        // no seed can give two equal values their own slots; equal values
+        // are always in the same bucket
+        for (size_t idx = 1; idx < nvalues_; idx++) {
+            for (size_t prev = 0; prev < idx; prev++) {
+                if (bucket_of[prev] == bucket_of[idx] && equal(values[prev], values[idx]))
+                    duplicate_value_error(values[idx]);
+            }
+        }
+        // place the biggest buckets first while most slots are still free
+        size_t order[nbuckets] {};
+        for (size_t bucket = 0; bucket < nbuckets; bucket++) {
+            size_t pos = bucket;
+            for (; pos > 0 && bucket_size[order[pos - 1]] < bucket_size[bucket]; pos--)
+                order[pos] = order[pos - 1];
+            order[pos] = bucket;
+        }
+        for (size_t bucket: order) {
+            if (bucket_size[bucket] == 0)
+                break;
+            bool placed = false;
+            for (uint32_t seed = 1; !placed && seed <= UINT16_MAX; seed++) {
+                placed = true;
+                for (size_t idx = 0; placed && idx < nvalues_; idx++) {
+                    if (bucket_of[idx] == bucket) {
+                        uint8_t& slot = slots[Flash_enum_table::hash(values[idx], seed) & (nslots - 1)];
+                        if (slot == 0)
+                            slot = static_cast<uint8_t>(idx + 1);
+                        else
+                            placed = false;
+                    }
+                }
+                if (placed) {
+                    seeds[bucket] = static_cast<uint16_t>(seed);
+                }
+                else {
+                    // take back the slots this seed filled
+                    for (size_t slot = 0; slot < nslots; slot++) {
+                        if (slots[slot] != 0 && bucket_of[slots[slot] - 1] == bucket)
+                            slots[slot] = 0;
+                    }
+                }
+            }
+            if (!placed)
+                no_seed_error(bucket);
+        }
+    }
+
+    constexpr size_t size() const { return nvalues_; }
+    constexpr const char* operator[](size_t idx) const { return values[idx]; }
+
+    /**
+     * @brief get the table that Setting_flash_enum uses
+     */
+    constexpr Flash_enum_table get_table() const
+    {
+        return Flash_enum_table{values, nvalues_, seeds, nbuckets - 1, slots, nslots - 1};
+    }
+private:
+    static constexpr bool equal(const char* lhs, const char* rhs)
+    {
+        for (; *lhs != '\0' && *lhs == *rhs; lhs++, rhs++)
+        {}
+        return *lhs == *rhs;
+    }
+
+    // The error functions are not constexpr, so calling one while the
+    // compiler computes the table is a compile error that names it.
+    static void duplicate_value_error(const char* value)
+    {
+        printf("Flash_enum_values: the value \"%s\" is in the table more than once\r\n", value);
+        fflush(stdout);
+        abort();
+    }
+    static void no_seed_error(size_t bucket)
+    {
+        printf("Flash_enum_values: no seed puts the values in bucket %zu in their own slots\r\n", bucket);
+        fflush(stdout);
+        abort();
+    }
+
+    /// the smallest power of 2 that is at least n
+    static constexpr size_t pow2_at_least(size_t n) { size_t pow2 = 1; while (pow2 < n) pow2 *= 2; return pow2; }
+    static constexpr size_t nbuckets = pow2_at_least(nvalues_);
+    static constexpr size_t nslots = pow2_at_least(2 * nvalues_);
+    const char* values[nvalues_];
+    uint16_t seeds[nbuckets];
+    uint8_t slots[nslots];
+};
+
+/**
+ * @brief a Setting_string_enum whose value strings are in a constant
+ * Flash_enum_values table instead of on the heap
+ *
+ * Setting the value by its string costs the same for any number of values,
+ * and get() returns a pointer to the string in the table.
+ */
+class Setting_flash_enum : public Setting_base
+{
+public:
+    Setting_flash_enum()=delete;
+
+    /**
+     * @brief Construct a new Setting_flash_enum object
+     *
+     * @param name_ the setting name; it must exist as long as this object
+     * @param values_ the table of value strings; the first value is the default.
+     * It must exist as long as this object; make it static constexpr.
+     */
+    template<size_t nvalues_>
+    Setting_flash_enum(const char* name_, const Flash_enum_values<nvalues_>& values_) :
+        name{name_}, table{values_.get_table()}
+    {
+        set_default();
+    }
+
+    bool operator==(const char* rhs) { return strcmp(get(), rhs) == 0; }
+    void set_default() { current = 0; }
+
+    /**
+     * @brief set the value to the string newval
+     *
+     * @return false if newval is not one of the values
+     */
+    bool set(const char* newval)
+    {
+        int idx = table.find(newval);
+        if (idx < 0)
+            return false;
+        current = static_cast<size_t>(idx);
+        return true;
+    }
+
+    bool set(size_t idx)
+    {
+        if (idx < table.nvalues) {
+            current = idx;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief get the current value string; the string is in the table, not a copy
+     */
+    const char* get() { return table.values[current]; }
+
+    int get_ivalue() { return static_cast<int>(current); }
+
+    size_t get_num_values() const { return table.nvalues; }
+    const char* get_value(size_t idx) const { return idx < table.nvalues ? table.values[idx] : nullptr; }
+
+    const char* incr(int delta) {
+        int idx = static_cast<int>(current) + delta;
+        if (idx < 0)
+            current = 0;
+        else if (idx >= static_cast<int>(table.nvalues))
+            current = table.nvalues - 1;
+        else
+            current = static_cast<size_t>(idx);
+        return get();
+    }
+
+    const char* get_name() { return name; }
+
+    void serialize(JSON_Object *root_object)
+    {
+        json_object_set_string(root_object, name, get());
+    }
+
+    virtual void serialize(Json_writer& writer)
+    {
+        writer.key(name);
+        writer.string(get());
+    }
+
+    bool deserialize(JSON_Object *root_object)
+    {
+        if (json_object_has_value_of_type(root_object, name, JSONString)) {
+            const char* val = json_object_get_string(root_object, name);
+            if (val == nullptr) {
+                printf("unexpected nullptr for setting %s\r\n", name);
+            }
+            else if (!set(val)) {
+                printf("%s is not legal for setting %s\r\n", val, name);
+                return false;
+            }
+        }
+        else {
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        return true;
+    }
+
+    virtual bool deserialize(const Json_event& event)
+    {
+        if (event.type != Json_event::string || event.depth != 0) {
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        if (!set(event.str)) {
+            printf("%s is not legal for setting %s\r\n", event.str, name);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief write the index of the value as one record of the binary settings format
+     */
+    virtual void serialize(Setting_binary_writer& writer)
+    {
+        size_t payload_start = writer.begin_record(name, Setting_binary_type::enum_index);
+        writer.put_varint(current);
+        writer.end_record(payload_start);
+    }
+
+    virtual bool deserialize(Setting_binary_type type, Setting_binary_reader& payload)
+    {
+        uint64_t idx;
+        if (type != Setting_binary_type::enum_index || !payload.get_varint(idx)) {
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        if (idx >= table.nvalues || !set(static_cast<size_t>(idx))) {
+            printf("%llu is not legal for setting %s\r\n", static_cast<unsigned long long>(idx), name);
+            return false;
+        }
+        return true;
+    }
+private:
+    const char* name;
+    const Flash_enum_table table;
+    size_t current;
+};
+}
@@ -0,0 +1,372 @@
+/**
+ * @file setting_list.h
+ *
+ * This class saves and loads a list of settings of different types. It
+ * can use the JSON format, for backups, or the compact binary format of
+ * setting_binary.h, which is faster to load and takes less space.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include "parson.h"
+#include "setting_base.h"
+#include "setting_binary.h"
+#include "json_writer.h"
+#include "json_reader.h"
+namespace rppicomidi
+{
+class Setting_list
+{
+public:
+    /**
+     * @brief Construct a new Setting_list object
+     *
+     * @param settings_ the array of settings; it must exist as long as this object
+     * @param nsettings_ the number of settings in the array
+     */
+    Setting_list(Setting_base* const* settings_, size_t nsettings_) :
+        settings{settings_}, nsettings{nsettings_}, next{0} {}
+
+    template<size_t nsettings_>
+    Setting_list(Setting_base* const (&settings_)[nsettings_]) : Setting_list{settings_, nsettings_} {}
+
+    Setting_list()=delete;
+
+    size_t size() const { return nsettings; }
+
+    Setting_base* get_setting(size_t idx) { return idx < nsettings ? settings[idx] : nullptr; }
+
+    /**
+     * @brief find the index of the setting whose name is the name_len characters at name
+     *
+     * The search starts after the setting the previous call found, so
+     * finding the settings in the order of the list takes one compare each.
+     * @return the index of the setting or -1 if no setting has the name
+     */
+    int find_idx(const char* name, size_t name_len)
+    {
+        for (size_t count = 0; count < nsettings; count++) {
+            size_t idx = next;
+            if (++next == nsettings)
+                next = 0;
+            const char* setting_name = settings[idx]->get_name();
+            if (strlen(setting_name) == name_len && memcmp(setting_name, name, name_len) == 0)
+                return static_cast<int>(idx);
+        }
+        return -1;
+    }
+
+    /**
+     * @brief find the setting whose name is the name_len characters at name
+     *
+     * @return the setting or nullptr if no setting has the name
+     */
+    Setting_base* find(const char* name, size_t name_len)
+    {
+        int idx = find_idx(name, name_len);
+        return idx < 0 ? nullptr : settings[idx];
+    }
+
+    void set_default()
+    {
+        for (size_t idx = 0; idx < nsettings; idx++)
+            settings[idx]->set_default();
+    }
+
+    /**
+     * @brief add all of the settings to the JSON root object
+     */
+    void serialize(JSON_Object *root_object)
+    {
+        for (size_t idx = 0; idx < nsettings; idx++)
+            settings[idx]->serialize(root_object);
+    }
+
+    /**
+     * @brief write all of the settings as one JSON object and finish the writer
+     *
+     * The JSON text is the same as the text json_serialize_to_string()
+     * makes after serialize(JSON_Object*), but no JSON values are allocated.
+     * @return the value of writer.finish()
+     */
+    bool serialize(Json_writer& writer)
+    {
+        writer.begin_object();
+        for (size_t idx = 0; idx < nsettings; idx++)
+            settings[idx]->serialize(writer);
+        writer.end_object();
+        return writer.finish();
+    }
+
+    /**
+     * @brief get all of the settings from the JSON root object
+     *
+     * @return false if any setting could not be deserialized; the other
+     * settings still get their values
+     */
+    bool deserialize(JSON_Object *root_object)
+    {
+        bool success = true;
+        for (size_t idx = 0; idx < nsettings; idx++) {
+            if (!settings[idx]->deserialize(root_object))
+                success = false;
+        }
+        return success;
+    }
+
+    /**
+     * @brief write all of the settings to buffer in the binary format
+     *
+     * @return the number of bytes written or 0 if buffer is too small
+     */
+    size_t serialize(uint8_t* buffer, size_t max_len)
+    {
+        Setting_binary_writer writer{buffer, max_len};
+        write_binary(writer);
+        return writer.ok() ? writer.size() : 0;
+    }
+
+    /**
+     * @brief get the size of the buffer serialize(uint8_t*, size_t) needs
+     */
+    size_t get_binary_size()
+    {
+        Setting_binary_writer writer{nullptr, 0};
+        write_binary(writer);
+        return writer.size();
+    }
+
+    /**
+     * @brief get all of the settings from data in the binary format
+     *
+     * Settings that have no record in the data get their default values,
+     * and records for names that are not in the list are skipped, so data
+     * from an older or a newer list of settings still loads.
+     *
+     * @return false if the data is not in the binary format or if any
+     * record could not be deserialized
+     */
+    bool deserialize(const uint8_t* data, size_t len)
+    {
+        Setting_binary_reader reader{data, len};
+        if (!reader.get_header()) {
+            printf("settings are not in the binary settings format\r\n");
+            return false;
+        }
+        set_default();
+        bool success = true;
+        while (!reader.at_end()) {
+            const char* name;
+            size_t name_len;
+            Setting_binary_type type;
+            Setting_binary_reader payload;
+            if (!reader.get_record(name, name_len, type, payload)) {
+                printf("binary settings record is not well formed\r\n");
+                return false;
+            }
+            Setting_base* setting = find(name, name_len);
+            if (setting && !setting->deserialize(type, payload))
+                success = false;
+        }
+        return success;
+    }
+
+    /**
+     * @brief return true if data starts with the binary settings format
+     * header, so a loader can accept both formats
+     */
+    static bool is_binary(const uint8_t* data, size_t len)
+    {
+        Setting_binary_reader reader{data, len};
+        return reader.get_header();
+    }
+
+    /**
+     * @brief convert settings in the binary format to JSON
+     *
+     * The list of settings describes the data. The settings hold the
+     * converted values while the function runs, and then get their own
+     * values back, so do not call this function while another context
+     * uses the settings.
+     * @return false if deserialize(data, len) fails
+     */
+    bool binary_to_json(const uint8_t* data, size_t len, JSON_Object *root_object)
+    {
+        std::vector<uint8_t> saved(get_binary_size());
+        serialize(saved.data(), saved.size());
+        bool success = deserialize(data, len);
+        if (success)
+            serialize(root_object);
+        deserialize(saved.data(), saved.size());
+        return success;
+    }
+
+    /**
+     * @brief convert settings in JSON to the binary format
+     *
+     * The list of settings describes the data. The settings hold the
+     * converted values while the function runs, and then get their own
+     * values back, so do not call this function while another context
+     * uses the settings.
+     * @return the number of bytes written or 0 if deserialize(root_object)
+     * fails or buffer is too small
+     */
+    size_t json_to_binary(JSON_Object *root_object, uint8_t* buffer, size_t max_len)
+    {
+        std::vector<uint8_t> saved(get_binary_size());
+        serialize(saved.data(), saved.size());
+        size_t nbytes = deserialize(root_object) ? serialize(buffer, max_len) : 0;
+        deserialize(saved.data(), saved.size());
+        return nbytes;
+    }
+private:
+    void write_binary(Setting_binary_writer& writer)
+    {
+        writer.put_header();
+        for (size_t idx = 0; idx < nsettings; idx++)
+            settings[idx]->serialize(writer);
+    }
+
+    Setting_base* const* settings;
+    size_t nsettings;
+    size_t next;    //!< the index where find() starts
+};
+
+/**
+ * @brief load the settings of a Setting_list from JSON text that arrives in
+ * chunks, without building a parson tree
+ *
+ * The members of the JSON object go straight to the settings with the same
+ * names, and members with other names are skipped. Loading takes a small,
+ * fixed amount of memory, so one reader loads lists of up to max_settings
+ * settings.
+ */
+class Setting_list_json_reader
+{
+public:
+    /**
+     * @brief Construct a new Setting_list_json_reader object
+     *
+     * @param list_ the settings to load; if it has more than max_settings
+     * settings, feed() and finish() fail
+     */
+    Setting_list_json_reader(Setting_list& list_) :
+        list{list_}, reader{on_event, this}, setting{nullptr}, nfound{0}, found{}, success{true}
+    {
+        if (list.size() > max_settings) {
+            printf("a Setting_list_json_reader loads at most %zu settings\r\n", max_settings);
+            success = false;
+        }
+    }
+    Setting_list_json_reader()=delete;
+
+    static const size_t max_settings = 128;
+
+    /**
+     * @brief parse the next len characters of the JSON text
+     *
+     * @return false if the text is not legal JSON or the list has too many settings
+     */
+    bool feed(const char* data, size_t len) { return list.size() <= max_settings && reader.feed(data, len); }
+
+    /**
+     * @brief tell the reader the JSON text is complete
+     *
+     * @return false if the text is not a legal JSON object, if any setting
+     * could not be deserialized, if the object does not have a member
+     * for every setting, or if the list has too many settings
+     */
+    bool finish()
+    {
+        if (list.size() > max_settings)
+            return false;
+        if (!reader.finish()) {
+            printf("settings are not a legal JSON object\r\n");
+            return false;
+        }
+        return success && nfound == list.size();
+    }
+
+    /**
+     * @brief read the JSON text in chunks with read_fn and load the settings
+     *
+     * @param read_fn the function that copies up to max_len characters to data;
+     * it returns the number of characters copied, or 0 at the end of the text
+     * @param context the context pointer for read_fn
+     * @return the value of finish()
+     */
+    bool load(size_t (*read_fn)(void* context, char* data, size_t max_len), void* context)
+    {
+        char chunk[64];
+        size_t len;
+        while ((len = read_fn(context, chunk, sizeof(chunk))) != 0 && feed(chunk, len))
+        {}
+        return finish();
+    }
+private:
+    static bool on_event(void* context, const Json_event& event)
+    {
+        auto me = static_cast<Setting_list_json_reader*>(context);
+        if (event.depth == 0) {
+            // the settings must be in one object
+            return event.type == Json_event::begin_object || event.type == Json_event::end_object;
+        }
+        if (event.depth == 1 && event.type == Json_event::key) {
+            int idx = me->list.find_idx(event.str, event.str_len);
+            if (idx < 0) {
+                me->setting = nullptr;
+            }
+            else {
+                me->setting = me->list.get_setting(idx);
+                // a setting that appears more than once only counts once
+                uint32_t mask = 1ul << (idx % 32);
+                if ((me->found[idx / 32] & mask) == 0) {
+                    me->found[idx / 32] |= mask;
+                    ++me->nfound;
+                }
+            }
+        }
+        else if (me->setting) {
+            Json_event setting_event = event;
+            --setting_event.depth;
+            if (!me->setting->deserialize(setting_event)) {
+                me->success = false;
+                me->setting = nullptr; // skip the rest of the value
+            }
+        }
+        return true;
+    }
+
+    Setting_list& list;
+    Json_reader reader;
+    Setting_base* setting;  //!< the setting that gets the events of the current member value, or nullptr to skip it
+    size_t nfound;          //!< the number of different settings that had members
+    uint32_t found[max_settings / 32]; //!< bit idx%32 of found[idx/32] is set if setting idx had a member
+    bool success;           //!< false if any setting could not be deserialized
+};
+}
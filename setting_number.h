@@ -30,11 +30,13 @@
 #pragma once
 #include <cstdint>
 #include <cstdio>
+#include <type_traits>
 #include "parson.h"
+#include "setting_base.h"
 namespace rppicomidi
 {
 template<typename T>
-class Setting_number
+class Setting_number : public Setting_base
 {
 public:
     Setting_number(const char* name_, T minval_, T maxval_, T def_val_) :
@@ -138,6 +140,16 @@ public:
      */
     void serialize(JSON_Object *root_object) {json_object_set_number(root_object, name, number);}
 
+    /**
+     * @brief write the number name value pair as the next member of the JSON
+     * object the writer is writing
+     */
+    virtual void serialize(Json_writer& writer)
+    {
+        writer.key(name);
+        writer.number(number);
+    }
+
     /**
      * @brief extract the value from the setting with the name of this object.
      * 
@@ -170,6 +182,67 @@ public:
         }
         return true;
     }
+
+    virtual bool deserialize(const Json_event& event)
+    {
+        if (event.type != Json_event::number || event.depth != 0) {
+            printf("Could not parse %s from settings\r\n", name);
+            return false;
+        }
+        if (!setting_number_fits<T>(event.value) || !set(static_cast<T>(event.value))) {
+            printf("Val %g out of range for %s\r\n", event.value, name);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief write the number as one record of the binary settings format:
+     * a zigzag varint for integral types, and the bytes of the number
+     * for floating point types
+     */
+    virtual void serialize(Setting_binary_writer& writer)
+    {
+        if constexpr (std::is_integral<T>::value) {
+            size_t payload_start = writer.begin_record(name, Setting_binary_type::integer);
+            writer.put_zigzag(static_cast<int64_t>(number));
+            writer.end_record(payload_start);
+        }
+        else {
+            size_t payload_start = writer.begin_record(name, Setting_binary_type::real);
+            writer.put_bytes(&number, sizeof(number));
+            writer.end_record(payload_start);
+        }
+    }
+
+    virtual bool deserialize(Setting_binary_type type, Setting_binary_reader& payload)
+    {
+        T val;
+        if constexpr (std::is_integral<T>::value) {
+            int64_t zigzag;
+            if (type != Setting_binary_type::integer || !payload.get_zigzag(zigzag)) {
+                printf("Could not parse %s from settings\r\n", name);
+                return false;
+            }
+            if (!setting_integer_fits<T>(zigzag)) {
+                printf("Val out of range for %s\r\n", name);
+                return false;
+            }
+            val = static_cast<T>(zigzag);
+        }
+        else {
+            // val != val for NaN, which set() would accept
+            if (type != Setting_binary_type::real || !payload.get_bytes(&val, sizeof(val)) || val != val) {
+                printf("Could not parse %s from settings\r\n", name);
+                return false;
+            }
+        }
+        if (!set(val)) {
+            printf("Val out of range for %s\r\n", name);
+            return false;
+        }
+        return true;
+    }
 private:
     const char* name;
     T minval;
@@ -34,9 +34,10 @@
 #include <vector>
 #include <cassert>
 #include "parson.h"
+#include "setting_base.h"
 namespace rppicomidi
 {
-class Setting_string_enum
+class Setting_string_enum : public Setting_base
 {
 public:
     Setting_string_enum()=delete;
@@ -71,17 +72,8 @@ public:
         return false;
     }
 
-    bool set(std::string& strval)
-    {
-        size_t idx = 0;
-        for (idx = 0; idx < value_list.size() && value_list[idx] != strval; idx++)
-        {}
-        if (idx < value_list.size())
-            return set(idx);
-        return false;
-    }
-
     void get(std::string& setting) {setting = (*current); }
+    const std::string& get() {return (*current); }
 
     int get_ivalue() {return current - value_list.begin(); }
 
@@ -97,11 +89,19 @@ public:
         return (*current);
     }
 
+    const char* get_name() { return name.c_str(); }
+
     void serialize(JSON_Object *root_object)
     {
         json_object_set_string(root_object, name.c_str(), (*current).c_str());
     }
 
+    virtual void serialize(Json_writer& writer)
+    {
+        writer.key(name.c_str());
+        writer.string((*current).c_str());
+    }
+
     bool deserialize(JSON_Object *root_object)
     {
         if (json_object_has_value_of_type(root_object, name.c_str(), JSONString)) {
@@ -120,6 +120,43 @@ public:
         }
         return true;
     }
+
+    virtual bool deserialize(const Json_event& event)
+    {
+        if (event.type != Json_event::string || event.depth != 0) {
+            printf("Could not parse %s from settings\r\n", name.c_str());
+            return false;
+        }
+        if (!set(std::string{event.str, event.str_len})) {
+            printf("%s is not legal for setting %s\r\n", event.str, name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief write the index of the value as one record of the binary settings format
+     */
+    virtual void serialize(Setting_binary_writer& writer)
+    {
+        size_t payload_start = writer.begin_record(name.c_str(), Setting_binary_type::enum_index);
+        writer.put_varint(get_ivalue());
+        writer.end_record(payload_start);
+    }
+
+    virtual bool deserialize(Setting_binary_type type, Setting_binary_reader& payload)
+    {
+        uint64_t idx;
+        if (type != Setting_binary_type::enum_index || !payload.get_varint(idx)) {
+            printf("Could not parse %s from settings\r\n", name.c_str());
+            return false;
+        }
+        if (idx >= value_list.size() || !set(static_cast<size_t>(idx))) {
+            printf("%llu is not legal for setting %s\r\n", static_cast<unsigned long long>(idx), name.c_str());
+            return false;
+        }
+        return true;
+    }
 private:
     std::string name;
     std::vector<std::string> value_list;
@@ -0,0 +1,85 @@
+/**
+ * @file static_menu.cpp
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "static_menu.h"
+
+rppicomidi::Static_menu::Static_menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_,
+    const Static_menu_item* items_, size_t num_items_) :
+    Virtual_menu{screen_, y_, menu_font_, *this}, items{items_}, num_items{num_items_}
+{
+}
+
+void rppicomidi::Static_menu::bind_row(size_t idx, Virtual_menu_row& row)
+{
+    const Static_menu_item& item = items[idx];
+    row.set_text(Menu_item_text::fixed(item.label, item.label_len));
+    if (item.kind == Static_menu_item::setting_value) {
+        char value[Static_menu_item::max_value_len+1];
+        item.get_text(item.setting, value);
+        row.set_value(value);
+    }
+    else {
+        row.set_value(nullptr);
+    }
+}
+
+rppicomidi::View::Select_result rppicomidi::Static_menu::on_select(size_t idx, View** new_view_)
+{
+    const Static_menu_item& item = items[idx];
+    *new_view_ = nullptr;
+    switch (item.kind) {
+    case Static_menu_item::launch_view:
+        *new_view_ = item.view;
+        return View::new_view;
+    case Static_menu_item::callback_fn:
+        item.callback(item.view, new_view_);
+        return *new_view_ ? View::new_view : View::no_op;
+    case Static_menu_item::setting_value:
+        // has_focus is still true if the item is not being edited yet
+        return has_focus ? View::take_focus : View::give_focus;
+    default:
+        return View::no_op;
+    }
+}
+
+bool rppicomidi::Static_menu::on_increment(size_t idx, uint32_t delta, bool is_shifted)
+{
+    const Static_menu_item& item = items[idx];
+    if (item.kind != Static_menu_item::setting_value)
+        return false;
+    if (is_shifted)
+        delta *= 10;
+    return item.incr(item.setting, static_cast<int>(delta));
+}
+
+bool rppicomidi::Static_menu::on_decrement(size_t idx, uint32_t delta, bool is_shifted)
+{
+    const Static_menu_item& item = items[idx];
+    if (item.kind != Static_menu_item::setting_value)
+        return false;
+    if (is_shifted)
+        delta *= 10;
+    return item.incr(item.setting, -static_cast<int>(delta));
+}
@@ -0,0 +1,200 @@
+/**
+ * @file static_menu.h
+ * @brief this class describes a menu whose items are defined
+ * in a constant table, so the item definitions stay in flash
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstring>
+#include <string>
+#include "view.h"
+#include "virtual_menu.h"
+#include "int_format.h"
+namespace rppicomidi {
+/**
+ * @brief the definition of one item in a Static_menu
+ *
+ * Use the constexpr factory functions to make the items. For example
+ *
+ *     static constexpr Static_menu_item main_menu_items[] = {
+ *         Static_menu_item::launch("Settings...", settings_menu),
+ *         Static_menu_item::number("Channel:", channel_setting),
+ *         Static_menu_item::string_enum("Mode:", mode_setting),
+ *         Static_menu_item::call("Save", &home_view, save_cb),
+ *     };
+ *
+ * where settings_menu, channel_setting, mode_setting and home_view are
+ * statically allocated objects. The compiler puts the whole table in flash.
+ */
+struct Static_menu_item
+{
+    enum Kind : uint8_t {
+        launch_view,    //!< Select pushes view to the View_manager stack
+        callback_fn,    //!< Select calls callback(view, new_view)
+        setting_value,  //!< Select starts or stops editing the setting with Up and Down
+    };
+
+    /// the maximum number of characters get_text() writes, not counting the terminating '\0'
+    static const size_t max_value_len = 20;
+
+    /**
+     * @brief make an item that pushes view_ to the View_manager stack when Select
+     * is pressed. view_ may be another Static_menu, which makes a menu tree.
+     */
+    template<size_t N>
+    static constexpr Static_menu_item launch(const char (&label_)[N], View& view_)
+    {
+        return Static_menu_item{label_, N-1, launch_view, &view_, nullptr, nullptr, nullptr, nullptr};
+    }
+
+    /**
+     * @brief make an item that calls callback_(view_, new_view) when Select
+     * is pressed. If the callback sets *new_view to a View, that View is
+     * pushed to the View_manager stack.
+     */
+    template<size_t N>
+    static constexpr Static_menu_item call(const char (&label_)[N], View* view_, void (*callback_)(View*, View**))
+    {
+        return Static_menu_item{label_, N-1, callback_fn, view_, callback_, nullptr, nullptr, nullptr};
+    }
+
+    /**
+     * @brief make an item that shows the value of a Setting_number object after
+     * the label and edits it the way an Int_spinner_menu_item does
+     */
+    template<size_t N, class Setting>
+    static constexpr Static_menu_item number(const char (&label_)[N], Setting& setting_)
+    {
+        return Static_menu_item{label_, N-1, setting_value, nullptr, nullptr, &setting_,
+            &get_number_text<Setting>, &incr_setting<Setting>};
+    }
+
+    /**
+     * @brief make an item that shows the value of a Setting_string_enum or
+     * Setting_flash_enum object
+     * after the label and edits it the way an Int_spinner_menu_item does
+     */
+    template<size_t N, class Setting>
+    static constexpr Static_menu_item string_enum(const char (&label_)[N], Setting& setting_)
+    {
+        return Static_menu_item{label_, N-1, setting_value, nullptr, nullptr, &setting_,
+            &get_string_text<Setting>, &incr_string_setting<Setting>};
+    }
+
+    const char* label;
+    size_t label_len;
+    Kind kind;
+    View* view;                             //!< the View to launch or the callback context
+    void (*callback)(View*, View**);        //!< the callback for a callback_fn item
+    void* setting;                          //!< the setting object for a setting_value item
+    void (*get_text)(void* setting, char* str); //!< write the setting value text to str, which holds max_value_len+1 characters
+    bool (*incr)(void* setting, int delta); //!< add delta to the setting value; return true if the value changed
+private:
+    template<class Setting>
+    static void get_number_text(void* setting_, char* str)
+    {
+        auto value = static_cast<Setting*>(setting_)->get();
+        char numstr[Int_format<decltype(value)>::max_chars+1];
+        size_t len = Int_format<decltype(value)>::to_dec(value, numstr, 0, false);
+        if (len > max_value_len)
+            len = max_value_len;
+        memcpy(str, numstr, len);
+        str[len] = '\0';
+    }
+
+    /// the value string of a Setting_string_enum or a Setting_flash_enum
+    static const char* value_c_str(const std::string& value) { return value.c_str(); }
+    static const char* value_c_str(const char* value) { return value; }
+
+    template<class Setting>
+    static void get_string_text(void* setting_, char* str)
+    {
+        strncpy(str, value_c_str(static_cast<Setting*>(setting_)->get()), max_value_len);
+        str[max_value_len] = '\0';
+    }
+
+    template<class Setting>
+    static bool incr_setting(void* setting_, int delta)
+    {
+        auto setting = static_cast<Setting*>(setting_);
+        auto prev = setting->get();
+        return setting->incr(delta) != prev;
+    }
+
+    template<class Setting>
+    static bool incr_string_setting(void* setting_, int delta)
+    {
+        auto setting = static_cast<Setting*>(setting_);
+        int prev = setting->get_ivalue();
+        setting->incr(delta);
+        return setting->get_ivalue() != prev;
+    }
+};
+
+/**
+ * @brief a menu that gets its items from a constant table of Static_menu_item
+ * definitions.
+ *
+ * The only RAM the menu uses is the Virtual_menu state and one row object
+ * per visible row; the labels are not copied. Make the Static_menu objects
+ * statically allocated too, and the RAM cost of the UI is known at link time.
+ */
+class Static_menu : public Virtual_menu_source, public Virtual_menu
+{
+public:
+    Static_menu()=delete;
+    /**
+     * @brief Construct a new Static_menu object
+     *
+     * @param screen_ the screen that will render the menu
+     * @param y_ the number of pixels from the top of the screen to start drawing the menu
+     * @param menu_font_ the font to render each item
+     * @param items_ the table of item definitions; it must exist as long as the menu
+     */
+    template<size_t N>
+    Static_menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_, const Static_menu_item (&items_)[N]) :
+        Static_menu{screen_, y_, menu_font_, items_, N} {}
+
+    Static_menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_,
+        const Static_menu_item* items_, size_t num_items_);
+    virtual ~Static_menu() = default;
+
+    // The Virtual_menu_source interface
+    virtual size_t get_num_rows() { return num_items; }
+    virtual void bind_row(size_t idx, Virtual_menu_row& row);
+    virtual View::Select_result on_select(size_t idx, View** new_view_);
+    virtual bool on_increment(size_t idx, uint32_t delta, bool is_shifted);
+    virtual bool on_decrement(size_t idx, uint32_t delta, bool is_shifted);
+
+    // Keep the View interface visible next to the Virtual_menu_source functions
+    using Virtual_menu::on_select;
+    using Virtual_menu::on_increment;
+    using Virtual_menu::on_decrement;
+    using Virtual_menu::on_left;
+    using Virtual_menu::on_right;
+protected:
+    const Static_menu_item* items;
+    size_t num_items;
+};
+}
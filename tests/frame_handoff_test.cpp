@@ -0,0 +1,162 @@
+/**
+ * @file frame_handoff_test.cpp
+ * @brief runs View_manager rendering on one thread and a display loop on
+ * another thread, the way core0 and core1 share a Frame_handoff, and
+ * checks that the display thread never gets a torn frame
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include "pico/stdlib.h"
+#include "frame_handoff.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+const uint32_t num_frames = 20000;
+
+/**
+ * @brief a View that draws frame number n as a whole screen of one color
+ * with a one pixel wide stripe of the other color at column (n/2) % 128.
+ * A frame made of parts of two frames has the wrong number of stripe bytes.
+ */
+class Frame_number_view : public View
+{
+public:
+    Frame_number_view(Mono_graphics& screen_) : View{screen_, Rectangle{0, 0, 128, 64}}, frame_number{0} {}
+    virtual void draw()
+    {
+        Pixel_state background = (frame_number & 1) ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO;
+        Pixel_state stripe = (frame_number & 1) ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE;
+        screen.draw_rectangle(view_rect, background, background);
+        screen.draw_rectangle((frame_number / 2) % 128, 0, 1, 64, stripe, stripe);
+    }
+    uint32_t frame_number;
+};
+
+/**
+ * @brief check that frame is one whole Frame_number_view frame
+ *
+ * @param frame_number set to the frame number modulo 256
+ * @return true if the frame is not torn
+ */
+bool decode_frame(const uint8_t* frame, size_t frame_size, uint32_t& frame_number)
+{
+    const size_t width = 128;
+    uint8_t background = frame[0] == frame[1] ? frame[0] : frame[2];
+    if (background != 0 && background != 0xff)
+        return false;
+    size_t stripe_x = width;
+    size_t nstripe_bytes = 0;
+    for (size_t idx = 0; idx < frame_size; idx++) {
+        if (frame[idx] == background)
+            continue;
+        if (frame[idx] != static_cast<uint8_t>(~background))
+            return false;
+        if (stripe_x == width)
+            stripe_x = idx % width;
+        else if (idx % width != stripe_x)
+            return false;
+        ++nstripe_bytes;
+    }
+    if (nstripe_bytes != frame_size / width)
+        return false;
+    frame_number = stripe_x * 2 + (background == 0xff ? 1 : 0);
+    return true;
+}
+}
+
+int main()
+{
+    Mono_graphics screen;
+    static Frame_handoff<1024> frame_handoff;
+    if (screen.get_canvas_size() != frame_handoff.get_frame_size()) {
+        printf("frame_handoff_test: the canvas is not 1024 bytes\n");
+        return 1;
+    }
+    Frame_number_view view{screen};
+    View_manager view_manager;
+    view_manager.push_view(&view);
+    view_manager.set_frame_interval_ms(1);
+    view_manager.set_frame_handoff(&frame_handoff, screen.get_canvas());
+
+    std::atomic<bool> rendering_done{false};
+    std::atomic<uint32_t> last_frame_number{0};
+    uint32_t ntorn = 0;
+    uint32_t nacquired = 0;
+    std::thread display([&]() {
+        for (;;) {
+            const uint8_t* frame;
+            if (frame_handoff.acquire(&frame)) {
+                uint32_t frame_number;
+                if (!decode_frame(frame, frame_handoff.get_frame_size(), frame_number))
+                    ++ntorn;
+                ++nacquired;
+                // take some time to "send" the frame so the render thread
+                // sometimes finds the buffer busy
+                if (nacquired % 4 == 0)
+                    std::this_thread::yield();
+                frame_handoff.release();
+                last_frame_number.store(frame_number);
+            }
+            else if (rendering_done.load()) {
+                break;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // the render thread: every millisecond of host time, draw the next frame
+    uint64_t now_us = 1000;
+    for (uint32_t frame_number = 1; frame_number <= num_frames; frame_number++) {
+        view.frame_number = frame_number;
+        view.invalidate();
+        now_us += 1000;
+        host_set_time_us(now_us);
+        view_manager.render();
+    }
+    // keep calling render() until the display thread has the last frame
+    for (uint32_t count = 0; count < 1000000 && last_frame_number.load() != num_frames % 256; count++) {
+        view_manager.render();
+        std::this_thread::yield();
+    }
+    rendering_done.store(true);
+    display.join();
+
+    int errors = 0;
+    if (ntorn != 0) {
+        printf("frame_handoff_test: %u of %u frames were torn\n", ntorn, nacquired);
+        ++errors;
+    }
+    if (last_frame_number.load() != num_frames % 256) {
+        printf("frame_handoff_test: the display did not get the last frame\n");
+        ++errors;
+    }
+    printf("frame_handoff_test: %s, %u frames sent to the display\n", errors == 0 ? "passed" : "FAILED", nacquired);
+    return errors == 0 ? 0 : 1;
+}
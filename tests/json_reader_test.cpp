@@ -0,0 +1,368 @@
+/**
+ * @file json_reader_test.cpp
+ * @brief checks that Json_reader gives the same events for JSON text cut
+ * into chunks anywhere, and that Setting_list_json_reader loads settings
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "json_reader.h"
+#include "setting_bimap.h"
+#include "setting_number.h"
+#include "setting_string_enum.h"
+#include "setting_flash_enum.h"
+#include "setting_list.h"
+
+using namespace rppicomidi;
+
+namespace {
+/// a small fixed PRNG so every run tests the same values
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief add one line per event to the std::string context: the type,
+ * the depth, the index and the string or number
+ */
+bool log_event(void* context, const Json_event& event)
+{
+    auto log = static_cast<std::string*>(context);
+    char line[32];
+    snprintf(line, sizeof(line), "%c%u.%zu", "{}[]ksnbz"[event.type], event.depth, event.index);
+    *log += line;
+    if (event.type == Json_event::key || event.type == Json_event::string) {
+        *log += '=';
+        for (size_t idx = 0; idx < event.str_len; idx++) {
+            uint8_t ch = static_cast<uint8_t>(event.str[idx]);
+            if (ch >= 0x20 && ch < 0x7f) {
+                *log += static_cast<char>(ch);
+            }
+            else {
+                snprintf(line, sizeof(line), "\\x%02x", ch);
+                *log += line;
+            }
+        }
+    }
+    else if (event.type == Json_event::number || event.type == Json_event::boolean) {
+        snprintf(line, sizeof(line), "=%.17g", event.value);
+        *log += line;
+    }
+    *log += ' ';
+    return true;
+}
+
+/**
+ * @brief parse text in chunks of chunk_len characters, starting with a
+ * chunk of first_len characters
+ *
+ * @param log gets the event log
+ * @return true if the text is legal JSON
+ */
+bool parse(const std::string& text, size_t first_len, size_t chunk_len, std::string& log)
+{
+    log.clear();
+    Json_reader reader{log_event, &log};
+    size_t pos = 0;
+    for (size_t len = first_len; pos < text.size(); len = chunk_len) {
+        if (len > text.size() - pos)
+            len = text.size() - pos;
+        // copy the chunk so the sanitizers see reads past its end
+        std::vector<char> chunk(text.begin() + pos, text.begin() + pos + len);
+        if (!reader.feed(chunk.data(), chunk.size()))
+            return false;
+        pos += len;
+    }
+    return reader.finish();
+}
+
+/**
+ * @brief parse text whole, cut in two at every position, and one character
+ * at a time, and compare the events with expected
+ *
+ * @return the number of errors
+ */
+int check_events(const char* name, const std::string& text, const std::string& expected)
+{
+    int errors = 0;
+    std::string log;
+    if (!parse(text, text.size(), text.size(), log) || log != expected) {
+        printf("%s: the events are\n  %s\n  instead of\n  %s\n", name, log.c_str(), expected.c_str());
+        ++errors;
+    }
+    for (size_t first_len = 0; first_len <= text.size(); first_len++) {
+        if ((!parse(text, first_len, text.size(), log) || log != expected) && errors++ < 10)
+            printf("%s: cut at %zu, the events are\n  %s\n", name, first_len, log.c_str());
+    }
+    if (!parse(text, 1, 1, log) || log != expected) {
+        printf("%s: one character at a time, the events are\n  %s\n", name, log.c_str());
+        ++errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief check the events of legal JSON text with every kind of value,
+ * escape and number, wherever the chunks split it
+ *
+ * @return the number of errors
+ */
+int test_events()
+{
+    int errors = check_events("values",
+        " {\"a\\\"b\\\\c\\/d\" : [1, -0.5e+3, \"x\\ty\\b\\f\\n\\r\", true, false, null, {}, []],\r\n"
+        "\t\"\\u0041\\u00e9\\u20AC\":{\"n\":1234567890,\"m\":-6.25E-2, \"\":\"\"}}\n",
+        "{0.0 k1.0=a\"b\\c/d [1.0 n2.0=1 n2.1=-500 s2.2=x\\x09y\\x08\\x0c\\x0a\\x0d b2.3=1 b2.4=0 z2.5 "
+        "{2.6 }2.0 [2.7 ]2.0 ]1.8 k1.0=A\\xc3\\xa9\\xe2\\x82\\xac {1.0 k2.0=n n2.0=1234567890 "
+        "k2.0=m n2.0=-0.0625 k2.0= s2.0= }1.3 }0.2 ");
+    errors += check_events("top level number", "-12.5", "n0.0=-12.5 ");
+    errors += check_events("top level literal", "null ", "z0.0 ");
+
+    // the longest token and the deepest nesting the reader accepts
+    std::string longest(Json_reader::max_token_len, 'k');
+    std::string text = "{\"" + longest + "\":\"" + longest + "\"}";
+    errors += check_events("longest tokens", text, "{0.0 k1.0=" + longest + " s1.0=" + longest + " }0.1 ");
+    std::string expected;
+    text.clear();
+    for (unsigned depth = 0; depth < Json_reader::max_depth; depth++) {
+        text += '[';
+        expected += "[" + std::to_string(depth) + ".0 ";
+    }
+    for (unsigned depth = Json_reader::max_depth; depth > 0; depth--) {
+        text += ']';
+        expected += "]" + std::to_string(depth - 1) + (depth == Json_reader::max_depth ? ".0 " : ".1 ");
+    }
+    errors += check_events("deepest nesting", text, expected);
+    return errors;
+}
+
+/**
+ * @brief check that illegal JSON text fails whole and one character at a time
+ *
+ * @return the number of errors
+ */
+int test_illegal_text()
+{
+    const std::string too_long(Json_reader::max_token_len + 1, 'k');
+    const std::string too_deep(Json_reader::max_depth + 1, '[');
+    const std::string illegal[] = {
+        "", " ", "{", "{\"a\":1,}", "{\"a\" 1}", "{\"a\":1]", "[1,2", "[1,,2]", "{1:2}", "\"abc", "\"a\\x\"",
+        "\"\\u12G4\"", "\"\\ud83d\"", "\"tab\there\"", "1 2", "{} {}", "tru", "nul", "truex", "-", "1.", "1e",
+        "+1", "\"" + too_long + "\"", "{\"" + too_long + "\":1}", too_deep + std::string(too_deep.size(), ']'),
+    };
+    int errors = 0;
+    std::string log;
+    for (const std::string& text: illegal) {
+        if (parse(text, text.size(), text.size(), log) || parse(text, 1, 1, log)) {
+            printf("illegal text: %s was accepted\n", text.c_str());
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+constexpr const char* mode_strings[] = {"Off", "a/b", "q\"\\\x01\x1f\n\t", "\xc3\xa9t\xc3\xa9"};
+constexpr Flash_enum_values<4> mode_values{mode_strings};
+
+/// one setting of each type, with names and values that need escapes
+struct All_settings
+{
+    Setting_number<int32_t> count{"a/b\"c", INT32_MIN, INT32_MAX, 5};
+    Setting_number<double> gain{"gain\r", -1e300, 1e300, 0.5};
+    Setting_number<uint32_t> big{"big", 0, UINT32_MAX, 0};
+    Setting_string_enum shape{"shape\\", {"x", "y/z", "\x02"}};
+    Setting_flash_enum mode{"mode", mode_values};
+    Setting_bimap<int16_t> map{"map", -1000, 1000};
+    Setting_bimap_fixed<uint8_t, 4> small_map{"small_map", 0, 127};
+    Setting_base* settings[7] = {&count, &gain, &big, &shape, &mode, &map, &small_map};
+    Setting_list list{settings};
+};
+
+std::string to_json(Setting_list& list)
+{
+    JSON_Value* root_value = json_value_init_object();
+    list.serialize(json_value_get_object(root_value));
+    char* serialized = json_serialize_to_string(root_value);
+    std::string result{serialized};
+    json_free_serialized_string(serialized);
+    json_value_free(root_value);
+    return result;
+}
+
+bool load(Setting_list& list, const std::string& text, size_t chunk_len)
+{
+    Setting_list_json_reader reader{list};
+    for (size_t pos = 0; pos < text.size(); pos += chunk_len) {
+        size_t len = text.size() - pos < chunk_len ? text.size() - pos : chunk_len;
+        if (!reader.feed(text.data() + pos, len))
+            break;
+    }
+    return reader.finish();
+}
+
+/// the read function for Setting_list_json_reader::load()
+struct Text_source
+{
+    const std::string& text;
+    size_t pos;
+};
+
+size_t read_text(void* context, char* data, size_t max_len)
+{
+    auto source = static_cast<Text_source*>(context);
+    size_t len = source->text.size() - source->pos;
+    if (len > max_len)
+        len = max_len;
+    memcpy(data, source->text.data() + source->pos, len);
+    source->pos += len;
+    return len;
+}
+
+/**
+ * @brief load random settings from JSON text with whitespace and unknown
+ * members in chunks of several sizes and compare them with the saved settings
+ *
+ * @return the number of errors
+ */
+int test_load_settings()
+{
+    int errors = 0;
+    uint32_t state = 0x2545f491u;
+    for (int trial = 0; trial < 50 && errors < 10; trial++) {
+        All_settings saved;
+        saved.count.set(static_cast<int32_t>(next_random(state)));
+        saved.big.set(next_random(state));
+        double value = static_cast<int32_t>(next_random(state)) / 1000.0;
+        saved.gain.set(trial % 3 == 0 ? static_cast<int>(value) : value);
+        saved.shape.set(static_cast<size_t>(next_random(state) % 3));
+        saved.mode.set(static_cast<size_t>(next_random(state) % 4));
+        for (uint32_t npairs = next_random(state) % 20; npairs > 0; npairs--)
+            saved.map.push_back(static_cast<int>(next_random(state) % 2001) - 1000, static_cast<int>(next_random(state) % 2001) - 1000);
+        for (uint32_t npairs = next_random(state) % 5; npairs > 0; npairs--)
+            saved.small_map.push_back(next_random(state) % 128, next_random(state) % 128);
+        const std::string expected = to_json(saved.list);
+        const std::string text = " {\"skip\" : {\"k\":[1,2,{\"q\":null}],\"t\":true}, " +
+            expected.substr(1, expected.size() - 2) + " ,\"\\u0041\":false, \"n\": -1.5e3 }\n";
+        for (size_t chunk_len: {1, 2, 3, 7, 64, 1000}) {
+            All_settings loaded;
+            if ((!load(loaded.list, text, chunk_len) || to_json(loaded.list) != expected) && errors++ < 10)
+                printf("load settings %d: %zu character chunks loaded %s\n", trial, chunk_len, to_json(loaded.list).c_str());
+        }
+        All_settings loaded;
+        Text_source source{text, 0};
+        Setting_list_json_reader reader{loaded.list};
+        if ((!reader.load(read_text, &source) || to_json(loaded.list) != expected) && errors++ < 10)
+            printf("load settings %d: load() loaded %s\n", trial, to_json(loaded.list).c_str());
+        for (size_t len = 0; len + 1 < expected.size(); len += 5) {
+            if (load(loaded.list, expected.substr(0, len), 5) && errors++ < 10)
+                printf("load settings %d: loaded the first %zu characters\n", trial, len);
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief check that a setting that appears more than once counts once, so
+ * a missing setting still makes finish() fail, also for lists longer than
+ * one word of the found bitmap, and that lists longer than the bitmap fail
+ *
+ * @return the number of errors
+ */
+int test_duplicate_keys()
+{
+    int errors = 0;
+    Setting_number<int> first{"a", -100, 100, 0};
+    Setting_number<int> second{"b", -100, 100, 0};
+    Setting_base* settings[] = {&first, &second};
+    Setting_list list{settings};
+    struct {
+        const char* text;
+        bool loads;
+        int first;
+        int second;
+    } cases[] = {
+        {"{\"a\":1,\"b\":2}", true, 1, 2},
+        {"{\"a\":1,\"a\":2}", false, 2, 0},
+        {"{\"b\":1,\"a\":2,\"b\":3}", true, 2, 3},
+        {"{\"a\":1,\"x\":2}", false, 1, 0},
+        {"{\"b\":7,\"b\":8,\"a\":5}", true, 5, 8},
+    };
+    for (auto& test_case: cases) {
+        first.set_default();
+        second.set_default();
+        if (load(list, test_case.text, 3) != test_case.loads || first.get() != test_case.first ||
+                second.get() != test_case.second) {
+            printf("duplicate keys: %s loaded a=%d b=%d\n", test_case.text, first.get(), second.get());
+            ++errors;
+        }
+    }
+
+    for (size_t nsettings: {Setting_list_json_reader::max_settings, Setting_list_json_reader::max_settings + 1}) {
+        std::vector<std::string> names;
+        std::vector<std::unique_ptr<Setting_number<int>>> numbers;
+        std::vector<Setting_base*> many_settings;
+        names.reserve(nsettings);
+        for (size_t idx = 0; idx < nsettings; idx++) {
+            names.push_back("s" + std::to_string(idx));
+            numbers.emplace_back(new Setting_number<int>{names.back().c_str(), 0, 1000, 0});
+            many_settings.push_back(numbers.back().get());
+        }
+        Setting_list many_list{many_settings.data(), many_settings.size()};
+        // every setting but the last, and the first setting again once per missing setting
+        std::string text = "{";
+        for (size_t idx = 0; idx + 1 < nsettings; idx++)
+            text += "\"s" + std::to_string(idx) + "\":" + std::to_string(idx) + ",";
+        text += "\"s0\":7}";
+        if (load(many_list, text, 64)) {
+            printf("duplicate keys: %zu settings loaded with the last one missing\n", nsettings);
+            ++errors;
+        }
+        text.back() = ',';
+        text += "\"s" + std::to_string(nsettings - 1) + "\":1}";
+        bool loads = nsettings <= Setting_list_json_reader::max_settings;
+        if (load(many_list, text, 64) != loads) {
+            printf("duplicate keys: %zu settings %s\n", nsettings, loads ? "did not load" : "loaded");
+            ++errors;
+        }
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_events();
+    errors += test_illegal_text();
+    errors += test_load_settings();
+    errors += test_duplicate_keys();
+    printf("json_reader_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
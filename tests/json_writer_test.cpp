@@ -0,0 +1,238 @@
+/**
+ * @file json_writer_test.cpp
+ * @brief checks that Json_writer writes the same JSON text that
+ * json_serialize_to_string() writes, with and without a flush function
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "json_writer.h"
+#include "setting_bimap.h"
+#include "setting_number.h"
+#include "setting_string_enum.h"
+#include "setting_flash_enum.h"
+#include "setting_list.h"
+
+using namespace rppicomidi;
+
+namespace {
+/// a small fixed PRNG so every run tests the same values
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// strings with every kind of character parson escapes, and UTF-8
+const char* const odd_strings[] = {"", "plain", "a/b", "q\"\\", "\x01\x1f\x7f", "\b\f\n\r\t", "\xc3\xa9t\xc3\xa9"};
+constexpr const char* mode_strings[] = {"Off", "a/b", "q\"\\\x01\x1f\n\t", "\xc3\xa9t\xc3\xa9"};
+constexpr Flash_enum_values<4> mode_values{mode_strings};
+
+bool append(void* context, const char* data, size_t len)
+{
+    static_cast<std::string*>(context)->append(data, len);
+    return true;
+}
+
+bool fail_after_one_flush(void* context, const char*, size_t)
+{
+    return (*static_cast<int*>(context))++ == 0;
+}
+
+std::string to_string(JSON_Value* root_value)
+{
+    char* serialized = json_serialize_to_string(root_value);
+    std::string result{serialized};
+    json_free_serialized_string(serialized);
+    json_value_free(root_value);
+    return result;
+}
+
+/**
+ * @brief write expected with a buffer big enough for all of it, with a
+ * buffer one character too small, and with flush functions and buffers
+ * of many sizes, and compare the text
+ *
+ * @param write_fn writes the JSON text to a Json_writer and returns the
+ * value of finish()
+ * @return the number of errors
+ */
+template<typename Write_fn>
+int check_writes(const char* name, const std::string& expected, Write_fn write_fn)
+{
+    int errors = 0;
+    std::vector<char> buffer(expected.size() + 1);
+    Json_writer writer{buffer.data(), buffer.size()};
+    if (!write_fn(writer) || expected != buffer.data() || writer.get_length() != expected.size()) {
+        printf("%s: wrote %s\n  instead of %s\n", name, buffer.data(), expected.c_str());
+        ++errors;
+    }
+    // no room for the '\0'
+    Json_writer short_writer{buffer.data(), expected.size()};
+    if (write_fn(short_writer)) {
+        printf("%s: the text and its '\\0' fit in a buffer that is too short\n", name);
+        ++errors;
+    }
+    for (size_t buffer_size = 1; buffer_size < 70; buffer_size += 3) {
+        std::string flushed;
+        std::vector<char> flush_buffer(buffer_size);
+        Json_writer flush_writer{flush_buffer.data(), buffer_size, append, &flushed};
+        if ((!write_fn(flush_writer) || flushed != expected || flush_writer.get_length() != expected.size()) &&
+                errors++ < 10) {
+            printf("%s: with a %zu character buffer, flushed %s\n", name, buffer_size, flushed.c_str());
+        }
+    }
+    if (expected.size() > 8) {
+        int nflushes = 0;
+        std::vector<char> flush_buffer(4);
+        Json_writer flush_writer{flush_buffer.data(), flush_buffer.size(), fail_after_one_flush, &nflushes};
+        if (write_fn(flush_writer) || nflushes != 2) {
+            printf("%s: a failed flush was not reported\n", name);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief write nested objects and arrays of strings and numbers with
+ * Json_writer and with parson and compare the text
+ *
+ * @return the number of errors
+ */
+int test_values()
+{
+    const double numbers[] = {0, -0.0, 1, -1, 2147483647.0, -2147483648.0, 2147483648.0, -2147483649.0,
+        0.5, -3.25, 0.1, 1.0 / 3, 1e-300, 1e300, -1.7976931348623157e308, 4.9e-324, 123456789012.0};
+    const size_t nnumbers = sizeof(numbers) / sizeof(numbers[0]);
+    const size_t nstrings = sizeof(odd_strings) / sizeof(odd_strings[0]);
+
+    JSON_Value* root_value = json_value_init_object();
+    JSON_Object* root = json_value_get_object(root_value);
+    json_object_set_value(root, "numbers", json_value_init_array());
+    JSON_Array* number_array = json_object_get_array(root, "numbers");
+    for (double number: numbers)
+        json_array_append_number(number_array, number);
+    for (size_t idx = 0; idx < nstrings; idx++)
+        json_object_set_string(root, odd_strings[idx], odd_strings[nstrings - 1 - idx]);
+    json_object_set_value(root, "empty", json_value_init_object());
+    json_object_set_value(root, "nested", json_value_init_array());
+    JSON_Array* nested = json_object_get_array(root, "nested");
+    json_array_append_value(nested, json_value_init_array());
+    json_array_append_value(nested, json_value_init_object());
+    json_object_set_number(json_array_get_object(nested, 1), "x", 7);
+    json_array_append_value(nested, json_value_init_array());
+    json_array_append_string(json_array_get_array(nested, 2), "y");
+    json_array_append_number(json_array_get_array(nested, 2), -8);
+    const std::string expected = to_string(root_value);
+
+    return check_writes("values", expected, [&](Json_writer& writer) {
+        writer.begin_object();
+        writer.key("numbers");
+        writer.begin_array();
+        for (size_t idx = 0; idx < nnumbers; idx++)
+            writer.number(numbers[idx]);
+        writer.end_array();
+        for (size_t idx = 0; idx < nstrings; idx++) {
+            writer.key(odd_strings[idx]);
+            writer.string(odd_strings[nstrings - 1 - idx]);
+        }
+        writer.key("empty");
+        writer.begin_object();
+        writer.end_object();
+        writer.key("nested");
+        writer.begin_array();
+        writer.begin_array();
+        writer.end_array();
+        writer.begin_object();
+        writer.key("x");
+        writer.number(7);
+        writer.end_object();
+        writer.begin_array();
+        writer.string("y");
+        writer.number(-8);
+        writer.end_array();
+        writer.end_array();
+        writer.end_object();
+        return writer.finish();
+    });
+}
+
+/**
+ * @brief serialize a Setting_list of random settings with Json_writer and
+ * with parson and compare the text
+ *
+ * @return the number of errors
+ */
+int test_settings()
+{
+    int errors = 0;
+    uint32_t state = 0x2545f491u;
+    for (int trial = 0; trial < 100; trial++) {
+        Setting_number<int32_t> count{"a/b\"c", INT32_MIN, INT32_MAX, 5};
+        Setting_number<uint32_t> big{"big", 0, UINT32_MAX, 0};
+        Setting_number<double> gain{"gain\r", -1e300, 1e300, 0.5};
+        Setting_number<float> level{"level", -1e10f, 1e10f, 0};
+        Setting_string_enum shape{"shape\\", {"x", "y/z", "\x02"}};
+        Setting_flash_enum mode{"mode", mode_values};
+        Setting_bimap<int16_t> map{"map", -1000, 1000};
+        count.set(static_cast<int32_t>(next_random(state)));
+        big.set(next_random(state));
+        double value = static_cast<int32_t>(next_random(state)) / 1000.0;
+        if (trial % 3 == 0)
+            value = static_cast<int>(value);
+        else if (trial % 7 == 0)
+            value = 3e9;
+        gain.set(value);
+        level.set(static_cast<float>(value / 1000));
+        shape.set(static_cast<size_t>(next_random(state) % 3));
+        mode.set(static_cast<size_t>(next_random(state) % 4));
+        for (uint32_t npairs = next_random(state) % 20; npairs > 0; npairs--)
+            map.push_back(static_cast<int>(next_random(state) % 2001) - 1000, static_cast<int>(next_random(state) % 2001) - 1000);
+        Setting_base* settings[] = {&count, &big, &gain, &level, &shape, &mode, &map};
+        Setting_list list{settings};
+
+        JSON_Value* root_value = json_value_init_object();
+        list.serialize(json_value_get_object(root_value));
+        char name[32];
+        snprintf(name, sizeof(name), "settings %d", trial);
+        errors += check_writes(name, to_string(root_value), [&](Json_writer& writer) { return list.serialize(writer); });
+        if (errors >= 10)
+            break;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_values();
+    errors += test_settings();
+    printf("json_writer_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
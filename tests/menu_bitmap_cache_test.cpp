@@ -0,0 +1,129 @@
+/**
+ * @file menu_bitmap_cache_test.cpp
+ * @brief checks that a Menu with the Menu_item bitmap cache enabled draws
+ * the same pixels as a Menu without it
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "menu.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+const int num_items = 30;
+const int num_actions = 3000;
+
+/// a small fixed PRNG so every run tests the same actions
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+const Mono_mono_font& get_font(Mono_graphics& screen, int font_idx)
+{
+    return font_idx == 0 ? screen.get_font_8() : font_idx == 1 ? screen.get_font_12() : screen.get_font_16();
+}
+
+/// one Menu on its own screen, with or without the bitmap cache
+struct Menu_under_test {
+    Menu_under_test(int font_idx, bool cached) :
+        menu{screen, 5, get_font(screen, font_idx)}
+    {
+        const Mono_mono_font& font = get_font(screen, font_idx);
+        for (int idx = 0; idx < num_items; idx++) {
+            // rows of different lengths, some wider than the screen
+            char text[32];
+            snprintf(text, sizeof(text), "Item %d %.*s", idx, idx % 15, "xxxxxxxxxxxxxxx");
+            auto item = new Menu_item(text, screen, font);
+            item->set_bitmap_cache_enabled(cached);
+            items.push_back(item);
+            menu.add_menu_item(item);
+        }
+        view_manager.push_view(&menu);
+    }
+    Mono_graphics screen;
+    Menu menu;
+    View_manager view_manager;
+    std::vector<Menu_item*> items; //!< the menu owns these
+};
+
+/**
+ * @brief apply the same random actions to a cached and an uncached Menu
+ * and compare the screens after each one
+ *
+ * @return the number of actions after which the screens differed
+ */
+int test_font(int font_idx)
+{
+    Menu_under_test plain{font_idx, false};
+    Menu_under_test cached{font_idx, true};
+    uint32_t state = 0x9e3779b9u + static_cast<uint32_t>(font_idx);
+    int errors = 0;
+    for (int idx = 0; idx < num_actions; idx++) {
+        uint32_t action = next_random(state) % 6;
+        uint32_t delta = 1 + next_random(state) % 3;
+        if (action < 2) {
+            plain.view_manager.on_decrement(delta, false);
+            cached.view_manager.on_decrement(delta, false);
+        }
+        else if (action < 4) {
+            plain.view_manager.on_increment(delta, false);
+            cached.view_manager.on_increment(delta, false);
+        }
+        else if (action == 4) {
+            size_t item_idx = next_random(state) % num_items;
+            char text[32];
+            snprintf(text, sizeof(text), "New %d", idx);
+            plain.items[item_idx]->set_text(text);
+            plain.items[item_idx]->invalidate();
+            cached.items[item_idx]->set_text(text);
+            cached.items[item_idx]->invalidate();
+        }
+        else {
+            plain.menu.draw();
+            cached.menu.draw();
+        }
+        if (memcmp(plain.screen.get_canvas(), cached.screen.get_canvas(), plain.screen.get_canvas_size()) != 0) {
+            if (errors++ < 10)
+                printf("font %d: the screens differ after action %d\n", font_idx, idx);
+        }
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = 0;
+    for (int font_idx = 0; font_idx < 3; font_idx++)
+        errors += test_font(font_idx);
+    printf("menu_bitmap_cache_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file menu_item_pool_test.cpp
+ * @brief checks Menu_item_pool block allocation, exhaustion and the high
+ * water mark, alone and as the item allocator of a Menu
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include "menu.h"
+#include "menu_item_pool.h"
+
+using namespace rppicomidi;
+
+namespace {
+/**
+ * @brief allocate every block of a pool, check the blocks, free some and
+ * allocate them again
+ *
+ * @return the number of errors
+ */
+template<size_t block_size, size_t num_blocks>
+int test_pool(const char* name)
+{
+    int errors = 0;
+    static Menu_item_pool<block_size, num_blocks> pool;
+    void* blocks[num_blocks];
+    for (size_t idx = 0; idx < num_blocks; idx++) {
+        blocks[idx] = pool.allocate(block_size);
+        auto addr = reinterpret_cast<uintptr_t>(blocks[idx]);
+        if (blocks[idx] == nullptr || !pool.owns(blocks[idx]) || addr % alignof(std::max_align_t) != 0) {
+            printf("%s: block %zu is %p\n", name, idx, blocks[idx]);
+            ++errors;
+        }
+        // a block must not overlap the one before it
+        if (idx > 0 && blocks[idx] != nullptr && blocks[idx - 1] != nullptr) {
+            uintptr_t prev = reinterpret_cast<uintptr_t>(blocks[idx - 1]);
+            uintptr_t distance = addr > prev ? addr - prev : prev - addr;
+            if (distance < block_size) {
+                printf("%s: blocks %zu and %zu overlap\n", name, idx - 1, idx);
+                ++errors;
+            }
+        }
+    }
+    if (pool.allocate(1) != nullptr) {
+        printf("%s: allocated a block from a full pool\n", name);
+        ++errors;
+    }
+    if (pool.get_num_allocated() != num_blocks || pool.get_high_water_mark() != num_blocks) {
+        printf("%s: %zu allocated, high water mark %zu\n", name, pool.get_num_allocated(), pool.get_high_water_mark());
+        ++errors;
+    }
+    pool.deallocate(blocks[0]);
+    pool.deallocate(blocks[num_blocks - 1]);
+    pool.deallocate(nullptr);
+    if (pool.get_num_allocated() != num_blocks - 2 || pool.get_high_water_mark() != num_blocks) {
+        printf("%s: after 2 frees, %zu allocated, high water mark %zu\n", name, pool.get_num_allocated(),
+            pool.get_high_water_mark());
+        ++errors;
+    }
+    void* again = pool.allocate(block_size);
+    if (again != blocks[0] && again != blocks[num_blocks - 1]) {
+        printf("%s: did not reuse a freed block\n", name);
+        ++errors;
+    }
+    // the pool rounds the block size up, so ask for more than any rounding adds
+    if (pool.allocate(block_size + sizeof(void*) + alignof(std::max_align_t)) != nullptr) {
+        printf("%s: allocated a block for an object larger than the blocks\n", name);
+        ++errors;
+    }
+    int local;
+    if (pool.owns(&local)) {
+        printf("%s: owns a pointer to the stack\n", name);
+        ++errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief build a Menu from a pool until the pool is full, and check that
+ * erasing items and clearing the menu give the blocks back
+ *
+ * @return the number of errors
+ */
+int test_menu_items()
+{
+    const size_t num_blocks = 8;
+    int errors = 0;
+    Mono_graphics screen;
+    static Menu_item_pool<sizeof(Menu_item), num_blocks> pool;
+    Menu menu{screen, 0, screen.get_font_8()};
+    menu.set_item_allocator(&pool);
+    for (int rebuild = 0; rebuild < 3; rebuild++) {
+        size_t num_items = 0;
+        for (;;) {
+            char text[24];
+            snprintf(text, sizeof(text), "Item %zu", num_items);
+            Menu_item* item = menu.new_menu_item<Menu_item>(text, screen, screen.get_font_8());
+            if (item == nullptr)
+                break;
+            menu.add_menu_item(item);
+            ++num_items;
+        }
+        // an item from the heap may share the menu with the pool items
+        menu.add_menu_item(new Menu_item("Heap item", screen, screen.get_font_8()));
+        if (num_items != num_blocks || pool.get_num_allocated() != num_blocks) {
+            printf("menu items: rebuild %d: %zu items from the pool, %zu allocated\n", rebuild, num_items,
+                pool.get_num_allocated());
+            ++errors;
+        }
+        menu.draw();
+        menu.erase_current_item();
+        if (pool.get_num_allocated() != num_blocks - 1) {
+            printf("menu items: erase_current_item() did not free the block\n");
+            ++errors;
+        }
+        menu.clear();
+        if (pool.get_num_allocated() != 0) {
+            printf("menu items: clear() left %zu blocks allocated\n", pool.get_num_allocated());
+            ++errors;
+        }
+    }
+    if (pool.get_high_water_mark() != num_blocks) {
+        printf("menu items: high water mark %zu\n", pool.get_high_water_mark());
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_pool<sizeof(Menu_item), 6>("Menu_item blocks");
+    // smaller than a free list pointer and not a multiple of the alignment
+    errors += test_pool<1, 5>("1 byte blocks");
+    errors += test_pool<sizeof(std::max_align_t) + 1, 5>("odd size blocks");
+    errors += test_menu_items();
+    printf("menu_item_pool_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
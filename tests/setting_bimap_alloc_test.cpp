@@ -0,0 +1,183 @@
+/**
+ * @file setting_bimap_alloc_test.cpp
+ * @brief checks that Setting_bimap_fixed never allocates heap memory and
+ * that Setting_bimap::find() never allocates heap memory
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "setting_bimap.h"
+
+using namespace rppicomidi;
+
+//--------------------------------------------------------------------+
+// Heap allocation counting
+//--------------------------------------------------------------------+
+static uint64_t num_allocs = 0;
+
+void* operator new(size_t size)
+{
+    ++num_allocs;
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// std::stable_sort gets its temporary buffer with the nothrow versions
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++num_allocs;
+    return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    free(ptr);
+}
+
+namespace {
+const int num_rounds = 2000;
+
+/**
+ * @brief fill bimap, then change pairs and find values the way a MIDI
+ * remapper does while the user edits the map
+ *
+ * @return the number of finds that returned -1 for a value in the map
+ */
+template<typename T, typename Bimap>
+int edit_and_find(Bimap& bimap, T minval, T maxval)
+{
+    int errors = 0;
+    bimap.set_default();
+    for (size_t idx = 0; idx < bimap.get_max_size(); idx++)
+        bimap.push_back(static_cast<T>(minval + idx), static_cast<T>(maxval - idx));
+    for (int round = 0; round < num_rounds; round++) {
+        size_t idx = static_cast<size_t>(round) % bimap.size();
+        bimap.incr(idx, round % 2, round % 3 == 0 ? -1 : 1);
+        bimap.set(idx, (round + 1) % 2, static_cast<T>(minval + round % 50));
+        if (bimap.find(bimap.get(idx, 0), 0) < 0 || bimap.find(bimap.get(idx, 1), 1) < 0)
+            ++errors;
+        if (round % 10 == 0) {
+            bimap.erase(idx);
+            bimap.push_back(minval, maxval);
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief construct a Setting_bimap_fixed and edit it
+ *
+ * @return the number of errors
+ */
+template<typename T, size_t max_pairs>
+int test_fixed(const char* type_name, T minval, T maxval)
+{
+    uint64_t allocs_before = num_allocs;
+    Setting_bimap_fixed<T, max_pairs> bimap{"bimap", minval, maxval};
+    int errors = edit_and_find<T>(bimap, minval, maxval);
+    uint64_t nallocs = num_allocs - allocs_before;
+    if (nallocs != 0) {
+        printf("%s fixed: %llu heap allocations\n", type_name, static_cast<unsigned long long>(nallocs));
+        ++errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief check that find() does not allocate after each change to a
+ * Setting_bimap that stores its pairs on the heap
+ *
+ * @return the number of errors
+ */
+template<typename T>
+int test_heap_find(const char* type_name, T minval, T maxval)
+{
+    Setting_bimap<T> bimap{"bimap", minval, maxval};
+    for (int idx = 0; idx < 64; idx++)
+        bimap.push_back(static_cast<T>(minval + idx), static_cast<T>(maxval - idx));
+    uint64_t find_allocs = 0;
+    for (int round = 0; round < num_rounds; round++) {
+        size_t idx = static_cast<size_t>(round) % bimap.size();
+        bimap.incr(idx, round % 2, round % 3 == 0 ? -1 : 1);
+        uint64_t allocs_before = num_allocs;
+        bimap.find(bimap.get(idx, 0), 0);
+        bimap.find(bimap.get(idx, 1), 1);
+        find_allocs += num_allocs - allocs_before;
+    }
+    if (find_allocs != 0) {
+        printf("%s: find() made %llu heap allocations\n", type_name, static_cast<unsigned long long>(find_allocs));
+        return 1;
+    }
+    return 0;
+}
+}
+
+int main()
+{
+    int errors = test_fixed<uint8_t, 64>("uint8_t", 0, 127);
+    errors += test_fixed<uint16_t, 64>("uint16_t", 0, 1000);
+    errors += test_fixed<int, 64>("int", -500, 500);
+    errors += test_heap_find<uint16_t>("uint16_t", 0, 1000);
+    errors += test_heap_find<int>("int", -500, 500);
+    printf("setting_bimap_alloc_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
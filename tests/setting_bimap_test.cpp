@@ -0,0 +1,113 @@
+/**
+ * @file setting_bimap_test.cpp
+ * @brief checks Setting_bimap::find() against a linear scan of the pairs
+ * after random changes to the map
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include "setting_bimap.h"
+
+using namespace rppicomidi;
+
+namespace {
+const int num_operations = 200000;
+
+/// a small fixed PRNG so every run tests the same operations
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/**
+ * @brief apply random push_back(), set(), incr(), erase() and
+ * set_default() calls to a Setting_bimap and check every find() against
+ * the first matching pair a linear scan finds
+ *
+ * @param type_name the name of T for the error messages
+ * @return the number of wrong find() results
+ */
+template<typename T, typename Bimap = Setting_bimap<T>>
+int test_find(const char* type_name, T minval, T maxval)
+{
+    Bimap bimap{"bimap", minval, maxval};
+    uint32_t state = 0x2545f491u;
+    uint32_t range = static_cast<uint32_t>(static_cast<int>(maxval) - static_cast<int>(minval) + 1);
+    auto random_value = [&]() { return static_cast<T>(minval + static_cast<int>(next_random(state) % range)); };
+    int errors = 0;
+    for (int op = 0; op < num_operations; op++) {
+        uint32_t action = next_random(state) % 10;
+        if (action < 3) {
+            T first = random_value();
+            bimap.push_back(first, random_value());
+        }
+        else if (action == 3 && bimap.size() != 0) {
+            bimap.erase(next_random(state) % bimap.size());
+        }
+        else if (action == 4 && bimap.size() != 0) {
+            size_t bimap_idx = next_random(state) % bimap.size();
+            bimap.set(bimap_idx, next_random(state) % 2, random_value());
+        }
+        else if (action == 5 && bimap.size() != 0) {
+            size_t bimap_idx = next_random(state) % bimap.size();
+            bimap.incr(bimap_idx, next_random(state) % 2, static_cast<int>(next_random(state) % 7) - 3);
+        }
+        else if (action == 6 && next_random(state) % 50 == 0) {
+            bimap.set_default();
+        }
+        else {
+            T value = random_value();
+            size_t element_idx = next_random(state) % 2;
+            int expected = -1;
+            for (size_t idx = 0; idx < bimap.size(); idx++) {
+                if (bimap.get(idx, element_idx) == value) {
+                    expected = static_cast<int>(idx);
+                    break;
+                }
+            }
+            int found = bimap.find(value, element_idx);
+            if (found != expected) {
+                if (errors++ < 10)
+                    printf("%s: operation %d: find(%d, %zu) returned %d, expected %d\n", type_name, op,
+                        static_cast<int>(value), element_idx, found, expected);
+            }
+        }
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_find<uint8_t>("uint8_t", 0, 127);
+    errors += test_find<int8_t>("int8_t", -20, 20);
+    errors += test_find<uint16_t>("uint16_t", 0, 1000);
+    errors += test_find<int>("int", -50, 50);
+    errors += test_find<uint8_t, Setting_bimap_fixed<uint8_t, 40>>("uint8_t fixed", 0, 127);
+    errors += test_find<int, Setting_bimap_fixed<int, 40>>("int fixed", -50, 50);
+    printf("setting_bimap_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file setting_binary_test.cpp
+ * @brief checks that a Setting_list round trips every setting type through
+ * the binary settings format and converts it to and from JSON
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "setting_bimap.h"
+#include "setting_number.h"
+#include "setting_string_enum.h"
+#include "setting_flash_enum.h"
+#include "setting_list.h"
+
+using namespace rppicomidi;
+
+namespace {
+/// a small fixed PRNG so every run tests the same values
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+constexpr const char* mode_strings[] = {"Off", "On", "Auto"};
+constexpr Flash_enum_values<3> mode_values{mode_strings};
+
+/// one setting of each type and the list of them
+struct All_settings
+{
+    Setting_number<int32_t> count{"count", -100000, 100000, 5};
+    Setting_number<uint8_t> channel{"channel", 0, 255, 1};
+    Setting_number<double> gain{"gain", -10, 10, 0.5};
+    Setting_string_enum shape{"shape", {"sine", "square", "saw"}};
+    Setting_flash_enum mode{"mode", mode_values};
+    Setting_bimap<uint8_t> note_map{"note_map", 0, 127};
+    Setting_bimap_fixed<int16_t, 8> cc_map{"cc_map", -1000, 1000};
+    Setting_base* settings[7] = {&count, &channel, &gain, &shape, &mode, &note_map, &cc_map};
+    Setting_list list{settings};
+
+    /// set every setting to a random value
+    void randomize(uint32_t& state)
+    {
+        count.set(static_cast<int32_t>(next_random(state) % 200001) - 100000);
+        channel.set(static_cast<uint8_t>(next_random(state)));
+        gain.set((static_cast<int>(next_random(state) % 2001) - 1000) / 100.0);
+        shape.set(static_cast<size_t>(next_random(state) % 3));
+        mode.set(static_cast<size_t>(next_random(state) % 3));
+        note_map.set_default();
+        for (uint32_t npairs = next_random(state) % 200; npairs > 0; npairs--)
+            note_map.push_back(next_random(state) % 128, next_random(state) % 128);
+        cc_map.set_default();
+        for (uint32_t npairs = next_random(state) % 9; npairs > 0; npairs--)
+            cc_map.push_back(static_cast<int>(next_random(state) % 2001) - 1000, static_cast<int>(next_random(state) % 2001) - 1000);
+    }
+};
+
+/// the JSON text of the settings in a list, to compare lists
+std::string to_json(Setting_list& list)
+{
+    JSON_Value* root_value = json_value_init_object();
+    list.serialize(json_value_get_object(root_value));
+    char* serialized = json_serialize_to_string(root_value);
+    std::string result{serialized};
+    json_free_serialized_string(serialized);
+    json_value_free(root_value);
+    return result;
+}
+
+std::vector<uint8_t> to_binary(Setting_list& list)
+{
+    std::vector<uint8_t> data(list.get_binary_size());
+    list.serialize(data.data(), data.size());
+    return data;
+}
+
+/**
+ * @brief serialize random settings, deserialize them into another list and
+ * compare the lists; also check that a short buffer fails
+ *
+ * @return the number of errors
+ */
+int test_round_trip()
+{
+    int errors = 0;
+    uint32_t state = 0x2545f491u;
+    for (int trial = 0; trial < 100; trial++) {
+        All_settings saved, loaded;
+        saved.randomize(state);
+        loaded.randomize(state);
+        size_t nbytes = saved.list.get_binary_size();
+        std::vector<uint8_t> data(nbytes);
+        if (saved.list.serialize(data.data(), nbytes - 1) != 0 || saved.list.serialize(data.data(), nbytes) != nbytes) {
+            printf("round trip %d: serialize() did not check the buffer size\n", trial);
+            ++errors;
+        }
+        if (!Setting_list::is_binary(data.data(), nbytes) || !loaded.list.deserialize(data.data(), nbytes) ||
+                to_json(loaded.list) != to_json(saved.list)) {
+            if (errors++ < 10)
+                printf("round trip %d: the loaded settings differ\n", trial);
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief load data from a list with more settings into a list that has
+ * fewer settings and one setting the data does not have
+ *
+ * @return the number of errors
+ */
+int test_other_lists()
+{
+    int errors = 0;
+    uint32_t state = 0x7f4a7c15u;
+    All_settings saved;
+    saved.randomize(state);
+    saved.count.set(-77777);
+    saved.mode.set("Auto");
+    std::vector<uint8_t> data = to_binary(saved.list);
+
+    Setting_number<int32_t> count{"count", -100000, 100000, 5};
+    Setting_number<int32_t> added{"added", 0, 10, 3};
+    Setting_flash_enum mode{"mode", mode_values};
+    Setting_base* settings[3] = {&added, &count, &mode};
+    Setting_list list{settings};
+    added.set(9);
+    if (!list.deserialize(data.data(), data.size()) || count.get() != -77777 || strcmp(mode.get(), "Auto") != 0) {
+        printf("other lists: the known settings did not load past the unknown records\n");
+        ++errors;
+    }
+    if (added.get() != 3) {
+        printf("other lists: a setting with no record is %d instead of its default\n", added.get());
+        ++errors;
+    }
+    // and back: the unknown settings get their defaults
+    All_settings loaded;
+    loaded.randomize(state);
+    data = to_binary(list);
+    All_settings defaults;
+    defaults.count.set(-77777);
+    defaults.mode.set("Auto");
+    if (!loaded.list.deserialize(data.data(), data.size()) || to_json(loaded.list) != to_json(defaults.list)) {
+        printf("other lists: settings with no record did not get their defaults\n");
+        ++errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief check that a record with a value out of the range of the setting
+ * type fails, and that truncated or corrupted data fails without reading
+ * outside the data
+ *
+ * @return the number of errors
+ */
+int test_bad_data()
+{
+    int errors = 0;
+    // a record for a uint8_t setting written by an int32_t setting
+    Setting_number<int32_t> wide{"channel", 0, 1000, 300};
+    Setting_base* wide_settings[1] = {&wide};
+    Setting_list wide_list{wide_settings};
+    std::vector<uint8_t> data = to_binary(wide_list);
+    All_settings loaded;
+    if (loaded.list.deserialize(data.data(), data.size()) || loaded.channel.get() != 1) {
+        printf("bad data: 300 loaded into a uint8_t setting as %u\n", loaded.channel.get());
+        ++errors;
+    }
+
+    uint32_t state = 0x9e3779b9u;
+    All_settings saved;
+    saved.randomize(state);
+    data = to_binary(saved.list);
+    if (loaded.list.deserialize(data.data(), 3) || Setting_list::is_binary(data.data(), 3)) {
+        printf("bad data: accepted data with no format version\n");
+        ++errors;
+    }
+    // data cut at the end of a record is complete; the settings after it
+    // get their defaults
+    std::vector<size_t> record_ends;
+    for (size_t nsettings = 0; nsettings <= saved.list.size(); nsettings++)
+        record_ends.push_back(Setting_list{saved.settings, nsettings}.get_binary_size());
+    for (size_t len = 0; len < data.size(); len++) {
+        // copy the data so the sanitizers see reads past the end
+        std::vector<uint8_t> truncated(data.begin(), data.begin() + len);
+        bool is_record_end = std::find(record_ends.begin(), record_ends.end(), len) != record_ends.end();
+        if (loaded.list.deserialize(truncated.data(), truncated.size()) != is_record_end) {
+            printf("bad data: %zu bytes %s\n", len, is_record_end ? "failed" : "loaded");
+            ++errors;
+        }
+    }
+    for (size_t pos = 0; pos < data.size(); pos++) {
+        for (uint8_t byte: {0x00, 0x7f, 0x80, 0xff}) {
+            std::vector<uint8_t> corrupted = data;
+            corrupted[pos] = byte;
+            loaded.list.deserialize(corrupted.data(), corrupted.size());
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief check that binary_to_json() and json_to_binary() convert
+ * exactly and leave the live settings as they were
+ *
+ * @return the number of errors
+ */
+int test_conversions()
+{
+    int errors = 0;
+    uint32_t state = 0x1b873593u;
+    All_settings saved, live;
+    saved.randomize(state);
+    live.randomize(state);
+    const std::string live_json = to_json(live.list);
+    std::vector<uint8_t> data = to_binary(saved.list);
+    const std::string saved_json = to_json(saved.list);
+
+    JSON_Value* root_value = json_value_init_object();
+    if (!live.list.binary_to_json(data.data(), data.size(), json_value_get_object(root_value))) {
+        printf("conversions: binary_to_json() failed\n");
+        ++errors;
+    }
+    char* serialized = json_serialize_to_string(root_value);
+    if (saved_json != serialized) {
+        printf("conversions: binary_to_json() gave %s\n", serialized);
+        ++errors;
+    }
+    json_free_serialized_string(serialized);
+    json_value_free(root_value);
+
+    root_value = json_parse_string(saved_json.c_str());
+    std::vector<uint8_t> converted(data.size());
+    if (live.list.json_to_binary(json_value_get_object(root_value), converted.data(), converted.size()) != data.size() ||
+            converted != data) {
+        printf("conversions: json_to_binary() did not give the binary data\n");
+        ++errors;
+    }
+    json_value_free(root_value);
+    if (live.list.binary_to_json(data.data(), 3, nullptr)) {
+        printf("conversions: converted data with no format version\n");
+        ++errors;
+    }
+    if (to_json(live.list) != live_json) {
+        printf("conversions: the live settings changed\n");
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_round_trip();
+    errors += test_other_lists();
+    errors += test_bad_data();
+    errors += test_conversions();
+    printf("setting_binary_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file setting_flash_enum_test.cpp
+ * @brief checks that the Flash_enum_values perfect hash finds every value
+ * and no other string, and that Setting_flash_enum uses it
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "setting_flash_enum.h"
+
+using namespace rppicomidi;
+
+namespace {
+// value strings made by appending digits to a prefix, so the values are
+// short, similar strings
+#define VALUES_4(prefix) prefix "0", prefix "1", prefix "2", prefix "3"
+#define VALUES_16(prefix) VALUES_4(prefix "0"), VALUES_4(prefix "1"), VALUES_4(prefix "2"), VALUES_4(prefix "3")
+#define VALUES_64(prefix) VALUES_16(prefix "0"), VALUES_16(prefix "1"), VALUES_16(prefix "2"), VALUES_16(prefix "3")
+
+constexpr const char* small_strings[] = {"Off", "On", "Auto"};
+constexpr Flash_enum_values<3> small_values{small_strings};
+
+// the largest table a Flash_enum_values can hold
+constexpr const char* large_strings[] = {
+    VALUES_64("a"), VALUES_64("b"), VALUES_64("c"),
+    VALUES_16("d"), VALUES_16("e"), VALUES_16("f"),
+    VALUES_4("g"), VALUES_4("h"), VALUES_4("i"), "j", "",
+};
+constexpr size_t num_large = sizeof(large_strings) / sizeof(large_strings[0]);
+constexpr Flash_enum_values<num_large> large_values{large_strings};
+static_assert(num_large == 254, "the large table must be full");
+
+/**
+ * @brief check that find() gives the index of every value and -1 for
+ * strings that are not values
+ *
+ * @param values the table strings
+ * @param misses strings that are not in the table
+ * @return the number of wrong find() results
+ */
+int test_find(const char* name, const Flash_enum_table& table, const char* const* values,
+    const char* const* misses, size_t nmisses)
+{
+    int errors = 0;
+    for (size_t idx = 0; idx < table.nvalues; idx++) {
+        // find() must compare the strings, not the pointers
+        std::string value{values[idx]};
+        int found = table.find(value.c_str());
+        if (found != static_cast<int>(idx) && errors++ < 10)
+            printf("find %s: \"%s\" found at %d instead of %zu\n", name, values[idx], found, idx);
+    }
+    for (size_t idx = 0; idx < nmisses; idx++) {
+        int found = table.find(misses[idx]);
+        if (found != -1 && errors++ < 10)
+            printf("find %s: \"%s\" is not a value but was found at %d\n", name, misses[idx], found);
+    }
+    // many other strings, some of which are value strings with more digits
+    char str[16];
+    for (int idx = 0; idx < 100000; idx++) {
+        snprintf(str, sizeof(str), "%c%d", "abcdefghz"[idx % 9], idx);
+        int found = table.find(str);
+        if (found != -1 && strcmp(values[found], str) != 0 && errors++ < 10)
+            printf("find %s: \"%s\" found as \"%s\"\n", name, str, values[found]);
+    }
+    return errors;
+}
+
+/**
+ * @brief check that a Setting_flash_enum sets its value by string or index,
+ * clamps incr() and keeps its value when a set() fails
+ *
+ * @return the number of errors
+ */
+int test_setting()
+{
+    int errors = 0;
+    Setting_flash_enum mode{"mode", small_values};
+    if (strcmp(mode.get(), "Off") != 0 || mode.get_ivalue() != 0 || mode.get_num_values() != 3) {
+        printf("setting: the default value is \"%s\"\n", mode.get());
+        ++errors;
+    }
+    if (!mode.set("Auto") || mode.get_ivalue() != 2 || !(mode == "Auto")) {
+        printf("setting: set(\"Auto\") failed\n");
+        ++errors;
+    }
+    if (mode.set("auto") || mode.set("") || mode.set(static_cast<size_t>(3)) || mode.get_ivalue() != 2) {
+        printf("setting: a bad value changed the value to \"%s\"\n", mode.get());
+        ++errors;
+    }
+    if (strcmp(mode.incr(5), "Auto") != 0 || strcmp(mode.incr(-1), "On") != 0 || strcmp(mode.incr(-5), "Off") != 0) {
+        printf("setting: incr() did not clamp the value\n");
+        ++errors;
+    }
+    if (mode.get_value(1) == nullptr || strcmp(mode.get_value(1), "On") != 0 || mode.get_value(3) != nullptr) {
+        printf("setting: get_value() is wrong\n");
+        ++errors;
+    }
+
+    Setting_flash_enum large{"large", large_values};
+    large.set("e31");
+    JSON_Value* root_value = json_value_init_object();
+    large.serialize(json_value_get_object(root_value));
+    large.set_default();
+    if (!large.deserialize(json_value_get_object(root_value)) || strcmp(large.get(), "e31") != 0) {
+        printf("setting: the JSON round trip gave \"%s\"\n", large.get());
+        ++errors;
+    }
+    json_object_set_string(json_value_get_object(root_value), "large", "e310");
+    if (large.deserialize(json_value_get_object(root_value)) || strcmp(large.get(), "e31") != 0) {
+        printf("setting: deserialized a string that is not a value\n");
+        ++errors;
+    }
+    json_value_free(root_value);
+    return errors;
+}
+}
+
+int main()
+{
+    const char* small_misses[] = {"off", "Of", "Offf", "On ", "", "Auto\n", "Manual"};
+    const char* large_misses[] = {"a", "a004", "a0000", "A000", "g4", "h", "i00", "j0", " ", "b3333", "f40"};
+    int errors = test_find("small", small_values.get_table(), small_strings,
+        small_misses, sizeof(small_misses) / sizeof(small_misses[0]));
+    errors += test_find("large", large_values.get_table(), large_strings,
+        large_misses, sizeof(large_misses) / sizeof(large_misses[0]));
+    errors += test_setting();
+    printf("setting_flash_enum_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/**
+ * @file static_menu_test.cpp
+ * @brief checks that Static_menu items launch views, call callbacks, edit
+ * their settings and scroll like the items of a Virtual_menu
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstring>
+#include <vector>
+#include "static_menu.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+/// a View that counts how often the View_manager shows it
+class Counting_view : public View
+{
+public:
+    Counting_view(Mono_graphics& screen_) :
+        View{screen_, screen_.get_clip_rect()}, num_entries{0} {}
+    virtual void draw() { screen.clear_canvas(); }
+    virtual void entry() { ++num_entries; View::entry(); }
+    int num_entries;
+};
+
+/// a number setting with the get() and incr() functions of Setting_number
+class Number_setting
+{
+public:
+    Number_setting() : value{10} {}
+    uint8_t get() const { return value; }
+    uint8_t incr(int delta)
+    {
+        int next = value + delta;
+        value = static_cast<uint8_t>(next < 0 ? 0 : (next > 127 ? 127 : next));
+        return value;
+    }
+    uint8_t value;
+};
+
+/// a string setting with the functions of Setting_flash_enum
+class Enum_setting
+{
+public:
+    Enum_setting() : ivalue{0} {}
+    const char* get() const { return names[ivalue]; }
+    int get_ivalue() const { return ivalue; }
+    void incr(int delta)
+    {
+        int next = ivalue + delta;
+        ivalue = next < 0 ? 0 : (next > 2 ? 2 : next);
+    }
+    static constexpr const char* names[3] = {"Off", "Omni", "Poly"};
+    int ivalue;
+};
+
+Mono_graphics screen;
+Counting_view launched_view{screen};
+Number_setting channel;
+Enum_setting mode;
+int num_calls = 0;
+
+void count_call(View*, View** new_view)
+{
+    ++num_calls;
+    *new_view = nullptr;
+}
+
+void launch_call(View* view, View** new_view)
+{
+    ++num_calls;
+    *new_view = view;
+}
+
+constexpr Static_menu_item items[] = {
+    Static_menu_item::launch("Launch...", launched_view),
+    Static_menu_item::call("Count", nullptr, count_call),
+    Static_menu_item::call("Count and launch", &launched_view, launch_call),
+    Static_menu_item::number("Channel:", channel),
+    Static_menu_item::string_enum("Mode:", mode),
+    Static_menu_item::launch("Row 5", launched_view),
+    Static_menu_item::launch("Row 6", launched_view),
+    Static_menu_item::launch("Row 7", launched_view),
+    Static_menu_item::launch("Row 8", launched_view),
+    Static_menu_item::launch("Row 9", launched_view),
+    Static_menu_item::launch("Row 10", launched_view),
+    Static_menu_item::launch("Last row", launched_view),
+};
+const int num_items = sizeof(items) / sizeof(items[0]);
+
+/**
+ * @brief check the label and value text bind_row() gives a row
+ *
+ * @return 1 if the text is wrong, 0 otherwise
+ */
+int check_row(Static_menu& menu, size_t idx, const char* label, const char* value)
+{
+    Virtual_menu_row row{screen, screen.get_font_8()};
+    menu.bind_row(idx, row);
+    if (strcmp(row.get_text(), label) != 0 || strcmp(row.get_value(), value) != 0) {
+        printf("row %zu: \"%s%s\" instead of \"%s%s\"\n", idx, row.get_text(), row.get_value(), label, value);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief check that the launch and call items push views and call their
+ * callbacks
+ *
+ * @return the number of errors
+ */
+int test_select(Static_menu& menu, View_manager& view_manager)
+{
+    int errors = 0;
+    view_manager.on_select();
+    if (view_manager.get_current_view() != &launched_view || launched_view.num_entries != 1) {
+        printf("select: the launch item did not push the view\n");
+        ++errors;
+    }
+    view_manager.pop_view();
+    view_manager.on_decrement(1, false);
+    view_manager.on_select();
+    if (num_calls != 1 || view_manager.get_current_view() != &menu) {
+        printf("select: the call item made %d calls and changed the view\n", num_calls);
+        ++errors;
+    }
+    view_manager.on_decrement(1, false);
+    view_manager.on_select();
+    if (num_calls != 2 || view_manager.get_current_view() != &launched_view || launched_view.num_entries != 2) {
+        printf("select: the call item did not push the view its callback returned\n");
+        ++errors;
+    }
+    view_manager.pop_view();
+    return errors;
+}
+
+/**
+ * @brief edit the number and the string setting and check the values the
+ * settings and the rows have
+ *
+ * @return the number of errors
+ */
+int test_editing(Static_menu& menu, View_manager& view_manager)
+{
+    int errors = check_row(menu, 3, "Channel:", "10") + check_row(menu, 4, "Mode:", "Off");
+    view_manager.on_decrement(1, false);
+    view_manager.on_select();
+    std::vector<uint8_t> before(screen.get_canvas(), screen.get_canvas() + screen.get_canvas_size());
+    view_manager.on_increment(2, false);
+    view_manager.on_increment(1, true);
+    if (channel.value != 22 || menu.get_current_row_idx() != 3) {
+        printf("editing: channel %u, current row %d\n", channel.value, menu.get_current_row_idx());
+        ++errors;
+    }
+    errors += check_row(menu, 3, "Channel:", "22");
+    if (memcmp(before.data(), screen.get_canvas(), before.size()) == 0) {
+        printf("editing: the row was not redrawn with the new value\n");
+        ++errors;
+    }
+    view_manager.on_decrement(100, false);
+    errors += check_row(menu, 3, "Channel:", "0");
+    view_manager.on_select();
+    view_manager.on_decrement(1, false);
+    if (menu.get_current_row_idx() != 4 || channel.value != 0) {
+        printf("editing: the focus did not come back to the menu\n");
+        ++errors;
+    }
+    view_manager.on_select();
+    view_manager.on_increment(1, false);
+    errors += check_row(menu, 4, "Mode:", "Omni");
+    view_manager.on_increment(5, false);
+    errors += check_row(menu, 4, "Mode:", "Poly");
+    view_manager.on_select();
+    view_manager.on_decrement(1, false);
+    if (menu.get_current_row_idx() != 5 || mode.ivalue != 2) {
+        printf("editing: current row %d, mode %d\n", menu.get_current_row_idx(), mode.ivalue);
+        ++errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief scroll to the last row and past it, then back to the first row
+ *
+ * @return the number of errors
+ */
+int test_scrolling(Static_menu& menu, View_manager& view_manager)
+{
+    int errors = 0;
+    const int max_visible = screen.get_screen_height() / screen.get_font_8().height;
+    if (num_items <= max_visible) {
+        printf("scrolling: all %d rows fit on the screen\n", num_items);
+        ++errors;
+    }
+    view_manager.on_decrement(num_items, false);
+    if (menu.get_current_row_idx() != num_items - 1) {
+        printf("scrolling: current row %d instead of the last row\n", menu.get_current_row_idx());
+        ++errors;
+    }
+    // the menu draws the last row at the bottom of the screen
+    std::vector<uint8_t> at_end(screen.get_canvas(), screen.get_canvas() + screen.get_canvas_size());
+    view_manager.on_decrement(1, false);
+    if (menu.get_current_row_idx() != num_items - 1 ||
+            memcmp(at_end.data(), screen.get_canvas(), at_end.size()) != 0) {
+        printf("scrolling: moved past the last row\n");
+        ++errors;
+    }
+    view_manager.on_select();
+    if (view_manager.get_current_view() != &launched_view) {
+        printf("scrolling: the last row did not launch its view\n");
+        ++errors;
+    }
+    view_manager.pop_view();
+    view_manager.on_increment(num_items, false);
+    if (menu.get_current_row_idx() != 0) {
+        printf("scrolling: current row %d instead of the first row\n", menu.get_current_row_idx());
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    Static_menu menu{screen, 0, screen.get_font_8(), items};
+    View_manager view_manager;
+    view_manager.push_view(&menu);
+    int errors = test_select(menu, view_manager);
+    errors += test_editing(menu, view_manager);
+    menu.set_current_row_idx(0);
+    errors += test_scrolling(menu, view_manager);
+    printf("static_menu_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file text_entry_box_test.cpp
+ * @brief checks that the Text_entry_box incremental redraw leaves the same
+ * pixels on the screen as a full draw() after random keystrokes
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "text_entry_box.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+const int num_keystrokes = 20000;
+
+/// a small fixed PRNG so every run tests the same keystrokes
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void on_done(View*, bool) {}
+
+/**
+ * @brief type random keys into a Text_entry_box and compare the canvas
+ * after each render() with the canvas after a full draw()
+ *
+ * @param max_chars the Text_entry_box maximum text length
+ * @param deferred true to render with a frame interval and skip some
+ * frames so several keystrokes get rendered at once
+ * @return the number of mismatched frames
+ */
+int test_keystrokes(size_t max_chars, bool deferred)
+{
+    Mono_graphics screen;
+    View_manager view_manager;
+    if (deferred)
+        view_manager.set_frame_interval_ms(1);
+    Text_entry_box box{screen, "Name", max_chars, "", nullptr, on_done};
+    view_manager.push_view(&box);
+    const uint8_t keys[] = {HID_KEY_A, HID_KEY_A + 1, HID_KEY_DELETE, HID_KEY_BACKSPACE, HID_KEY_HOME, HID_KEY_END, HID_KEY_INSERT};
+    const size_t num_keys = sizeof(keys) / sizeof(keys[0]);
+    uint32_t state = 0x12345678u + static_cast<uint32_t>(max_chars);
+    uint64_t now_us = 1000;
+    std::vector<uint8_t> rendered(screen.get_canvas_size());
+    int nchecks = 0;
+    int errors = 0;
+    for (int idx = 0; idx < num_keystrokes; idx++) {
+        uint32_t action = next_random(state) % 12;
+        if (action < num_keys)
+            view_manager.on_key(keys[action], 0, true);
+        else if (action < 9)
+            view_manager.on_left(1, false);
+        else if (action < 11)
+            view_manager.on_right(1, false);
+        else
+            view_manager.on_key(HID_KEY_A + next_random(state) % 26, 0, true);
+        if (deferred && next_random(state) % 3 != 0)
+            continue;
+        now_us += 2000;
+        host_set_time_us(now_us);
+        view_manager.render();
+        memcpy(rendered.data(), screen.get_canvas(), rendered.size());
+        box.draw();
+        ++nchecks;
+        if (memcmp(rendered.data(), screen.get_canvas(), rendered.size()) != 0) {
+            if (errors++ < 10)
+                printf("max_chars=%zu%s: keystroke %d left different pixels than draw()\n",
+                    max_chars, deferred ? " deferred" : "", idx);
+        }
+    }
+    if (nchecks == 0) {
+        printf("max_chars=%zu%s: nothing checked\n", max_chars, deferred ? " deferred" : "");
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_keystrokes(40, false);
+    errors += test_keystrokes(40, true);
+    // a short box so inserts often find the text full
+    errors += test_keystrokes(8, false);
+    printf("text_entry_box_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
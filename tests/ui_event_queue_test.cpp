@@ -0,0 +1,135 @@
+/**
+ * @file ui_event_queue_test.cpp
+ * @brief checks that Ui_event_queue and View_manager::post_event() pass
+ * every event from producer threads to a consumer thread
+ * without losing, duplicating or reordering events
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include "ui_event_queue.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+const uint32_t num_events = 20000;
+
+/**
+ * @brief push numbered key events from one thread and pop them in another;
+ * every event must arrive once and in order
+ */
+int test_queue_order()
+{
+    Ui_event_queue<8> queue;
+    std::thread producer([&]() {
+        for (uint32_t idx = 0; idx < num_events; idx++) {
+            Ui_event event{static_cast<uint8_t>(idx), static_cast<uint8_t>(idx >> 8), true};
+            while (!queue.push(event))
+                std::this_thread::yield();
+        }
+    });
+    int errors = 0;
+    for (uint32_t idx = 0; idx < num_events;) {
+        Ui_event event;
+        if (!queue.pop(event)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (event.type != Ui_event::key || event.key_code != static_cast<uint8_t>(idx) ||
+                event.modifiers != static_cast<uint8_t>(idx >> 8)) {
+            if (errors++ < 10)
+                printf("queue order: event %u arrived out of order\n", static_cast<unsigned>(idx));
+        }
+        ++idx;
+    }
+    producer.join();
+    return errors;
+}
+
+/// adds up the deltas it gets so the test can check none were lost
+class Counting_view : public View
+{
+public:
+    Counting_view(Mono_graphics& screen_) : View{screen_, Rectangle{0, 0, 128, 64}}, increments{0}, lefts{0} {}
+    virtual void draw() {}
+    virtual void on_increment(uint32_t delta, bool) { increments += delta; }
+    virtual void on_left(uint32_t delta, bool) { lefts += delta; }
+    uint64_t increments;
+    uint64_t lefts;
+};
+
+/**
+ * @brief post from two producer threads, one per input source, the way a
+ * button timer interrupt and a USB keyboard callback do, while the main
+ * thread calls dispatch_pending(); the merged deltas must add up
+ */
+int test_two_sources()
+{
+    Mono_graphics screen;
+    Counting_view view{screen};
+    View_manager view_manager;
+    view_manager.push_view(&view);
+    view_manager.set_input_queued(true);
+    auto post_all = [&](Ui_event::Type type, View_manager::Input_source source) {
+        for (uint32_t idx = 0; idx < num_events; idx++) {
+            while (!view_manager.post_event(Ui_event{type, 1 + idx % 3, false}, source))
+                std::this_thread::yield();
+        }
+    };
+    std::atomic<int> ndone{0};
+    std::thread buttons([&]() { post_all(Ui_event::increment, View_manager::button_input); ++ndone; });
+    std::thread keyboard([&]() { post_all(Ui_event::left, View_manager::keyboard_input); ++ndone; });
+    while (ndone.load() < 2)
+        view_manager.dispatch_pending();
+    buttons.join();
+    keyboard.join();
+    view_manager.dispatch_pending();
+
+    uint64_t expected = 0;
+    for (uint32_t idx = 0; idx < num_events; idx++)
+        expected += 1 + idx % 3;
+    int errors = 0;
+    if (view.increments != expected) {
+        printf("two sources: got %llu increments, expected %llu\n",
+            static_cast<unsigned long long>(view.increments), static_cast<unsigned long long>(expected));
+        ++errors;
+    }
+    if (view.lefts != expected) {
+        printf("two sources: got %llu lefts, expected %llu\n",
+            static_cast<unsigned long long>(view.lefts), static_cast<unsigned long long>(expected));
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_queue_order();
+    errors += test_two_sources();
+    printf("ui_event_queue_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
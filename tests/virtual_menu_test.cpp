@@ -0,0 +1,292 @@
+/**
+ * @file virtual_menu_test.cpp
+ * @brief checks that a Virtual_menu draws the same pixels as a Menu with the
+ * same rows, that it binds only the visible rows, and that reload()
+ * and editing a row work
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "pico/stdlib.h"
+#include "menu.h"
+#include "virtual_menu.h"
+#include "view_manager.h"
+
+using namespace rppicomidi;
+
+namespace {
+const int num_actions = 2000;
+
+/// a small fixed PRNG so every run tests the same actions
+uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/// rows labeled "Row n" with a value that on_increment() changes after on_select()
+class Counting_source : public Virtual_menu_source
+{
+public:
+    Counting_source(size_t num_rows_) : num_rows{num_rows_}, num_binds{0}, edited_row{-1}, edited_value{0} {}
+    virtual size_t get_num_rows() { return num_rows; }
+    virtual void bind_row(size_t idx, Virtual_menu_row& row)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "Row %zu", idx);
+        row.set_text(text);
+        if (static_cast<int>(idx) == edited_row) {
+            snprintf(text, sizeof(text), " %d", edited_value);
+            row.set_value(text);
+        }
+        else {
+            row.set_value(nullptr);
+        }
+        ++num_binds;
+    }
+    virtual View::Select_result on_select(size_t idx, View** new_view_)
+    {
+        *new_view_ = nullptr;
+        if (edited_row == static_cast<int>(idx)) {
+            edited_row = -1;
+            return View::give_focus;
+        }
+        edited_row = static_cast<int>(idx);
+        return View::take_focus;
+    }
+    virtual bool on_increment(size_t idx, uint32_t delta, bool)
+    {
+        if (static_cast<int>(idx) != edited_row)
+            return false;
+        edited_value += delta;
+        return true;
+    }
+    size_t num_rows;
+    int num_binds;      //!< the number of bind_row() calls
+    int edited_row;     //!< the row on_select() took the focus for, or -1
+    int edited_value;
+};
+
+/// a Virtual_menu that lets the test count its row objects
+class Probe_menu : public Virtual_menu
+{
+public:
+    using Virtual_menu::Virtual_menu;
+    size_t get_num_row_objects() { return rows.size(); }
+};
+
+/**
+ * @brief move through a Virtual_menu and a Menu with the same rows and
+ * compare the screens after each move
+ *
+ * @param deferred true to render with a frame interval
+ * @return the number of moves after which the screens differed
+ */
+int test_matches_menu(bool deferred)
+{
+    const size_t num_rows = 100;
+    Mono_graphics menu_screen;
+    View_manager menu_view_manager;
+    Menu menu{menu_screen, 0, menu_screen.get_font_8()};
+    for (size_t idx = 0; idx < num_rows; idx++) {
+        char text[24];
+        snprintf(text, sizeof(text), "Row %zu", idx);
+        menu.add_menu_item(new Menu_item(text, menu_screen, menu_screen.get_font_8()));
+    }
+    Mono_graphics virtual_screen;
+    View_manager virtual_view_manager;
+    Counting_source source{num_rows};
+    Virtual_menu virtual_menu{virtual_screen, 0, virtual_screen.get_font_8(), source};
+    // the render deferred flag is global, so both View_managers get the same interval
+    menu_view_manager.set_frame_interval_ms(deferred ? 1 : 0);
+    virtual_view_manager.set_frame_interval_ms(deferred ? 1 : 0);
+    menu_view_manager.push_view(&menu);
+    virtual_view_manager.push_view(&virtual_menu);
+
+    uint32_t state = deferred ? 0x5eed1u : 0x5eed0u;
+    uint64_t now_us = 1000;
+    int errors = 0;
+    for (int idx = 0; idx < num_actions; idx++) {
+        uint32_t delta = 1 + next_random(state) % 3;
+        bool is_shifted = next_random(state) % 8 == 0;
+        if (next_random(state) % 2) {
+            menu_view_manager.on_decrement(delta, is_shifted);
+            virtual_view_manager.on_decrement(delta, is_shifted);
+        }
+        else {
+            menu_view_manager.on_increment(delta, is_shifted);
+            virtual_view_manager.on_increment(delta, is_shifted);
+        }
+        if (deferred) {
+            now_us += 2000;
+            host_set_time_us(now_us);
+            menu_view_manager.render();
+            virtual_view_manager.render();
+        }
+        if (menu.get_current_item_idx() != virtual_menu.get_current_row_idx() ||
+                memcmp(menu_screen.get_canvas(), virtual_screen.get_canvas(), menu_screen.get_canvas_size()) != 0) {
+            if (errors++ < 10)
+                printf("matches menu%s: the menus differ after move %d\n", deferred ? " deferred" : "", idx);
+        }
+    }
+    menu_view_manager.set_frame_interval_ms(0);
+    return errors;
+}
+
+/**
+ * @brief check that the menu only has and binds row objects for the
+ * rows on the screen, no matter how many rows the source has
+ *
+ * @return the number of errors
+ */
+int test_row_recycling()
+{
+    int errors = 0;
+    for (size_t num_rows: {3u, 100u, 10000u}) {
+        Mono_graphics screen;
+        View_manager view_manager;
+        Counting_source source{num_rows};
+        Probe_menu menu{screen, 0, screen.get_font_8(), source};
+        view_manager.push_view(&menu);
+        const size_t max_visible = screen.get_screen_height() / screen.get_font_8().height;
+        const int visible = static_cast<int>(num_rows < max_visible ? num_rows : max_visible);
+        if (menu.get_num_row_objects() != max_visible || source.num_binds != visible) {
+            printf("row recycling: %zu rows: %zu row objects and %d binds for %d visible rows\n",
+                num_rows, menu.get_num_row_objects(), source.num_binds, visible);
+            ++errors;
+        }
+        // scroll to the last row one row at a time; moving within the
+        // screen binds 2 rows and scrolling binds the visible rows
+        for (size_t idx = 1; idx < num_rows; idx++) {
+            source.num_binds = 0;
+            view_manager.on_decrement(1, false);
+            if (menu.get_current_row_idx() != static_cast<int>(idx) || source.num_binds > visible) {
+                printf("row recycling: %zu rows: moving to row %zu made row %d current with %d binds\n",
+                    num_rows, idx, menu.get_current_row_idx(), source.num_binds);
+                ++errors;
+                break;
+            }
+        }
+        // past the last row
+        view_manager.on_decrement(1, false);
+        if (menu.get_current_row_idx() != static_cast<int>(num_rows - 1)) {
+            printf("row recycling: %zu rows: moved past the last row\n", num_rows);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief check that reload() keeps the current row in range and, with
+ * deferred rendering, draws on the next render() instead of right away
+ *
+ * @return the number of errors
+ */
+int test_reload()
+{
+    int errors = 0;
+    Mono_graphics screen;
+    View_manager view_manager;
+    Counting_source source{100};
+    Virtual_menu menu{screen, 0, screen.get_font_8(), source};
+    view_manager.set_frame_interval_ms(1);
+    view_manager.push_view(&menu);
+    uint64_t now_us = 1000;
+    host_set_time_us(now_us);
+    view_manager.render();
+    menu.set_current_row_idx(50);
+    source.num_rows = 5;
+    source.num_binds = 0;
+    menu.reload();
+    if (menu.get_current_row_idx() != 4 || source.num_binds != 0) {
+        printf("reload: current row %d and %d binds before render()\n", menu.get_current_row_idx(), source.num_binds);
+        ++errors;
+    }
+    now_us += 2000;
+    host_set_time_us(now_us);
+    view_manager.render();
+    if (source.num_binds != 5) {
+        printf("reload: render() bound %d rows instead of 5\n", source.num_binds);
+        ++errors;
+    }
+    source.num_rows = 0;
+    menu.reload();
+    if (menu.get_current_row_idx() != -1) {
+        printf("reload: an empty menu has current row %d\n", menu.get_current_row_idx());
+        ++errors;
+    }
+    view_manager.set_frame_interval_ms(0);
+    return errors;
+}
+
+/**
+ * @brief check that after on_select() takes the focus, increments go to the
+ * source for the current row and the menu redraws that row
+ *
+ * @return the number of errors
+ */
+int test_editing()
+{
+    int errors = 0;
+    Mono_graphics screen;
+    View_manager view_manager;
+    Counting_source source{20};
+    Virtual_menu menu{screen, 0, screen.get_font_8(), source};
+    view_manager.push_view(&menu);
+    view_manager.on_decrement(10, false);
+    view_manager.on_select();
+    std::vector<uint8_t> before(screen.get_canvas(), screen.get_canvas() + screen.get_canvas_size());
+    view_manager.on_increment(3, false);
+    if (source.edited_row != 10 || source.edited_value != 3 || menu.get_current_row_idx() != 10) {
+        printf("editing: row %d value %d current row %d\n", source.edited_row, source.edited_value, menu.get_current_row_idx());
+        ++errors;
+    }
+    if (memcmp(before.data(), screen.get_canvas(), before.size()) == 0) {
+        printf("editing: the row was not redrawn with the new value\n");
+        ++errors;
+    }
+    view_manager.on_select();
+    view_manager.on_decrement(1, false);
+    if (source.edited_row != -1 || menu.get_current_row_idx() != 11) {
+        printf("editing: the focus did not come back to the menu\n");
+        ++errors;
+    }
+    return errors;
+}
+}
+
+int main()
+{
+    int errors = test_matches_menu(false);
+    errors += test_matches_menu(true);
+    errors += test_row_recycling();
+    errors += test_reload();
+    errors += test_editing();
+    printf("virtual_menu_test: %s\n", errors == 0 ? "passed" : "FAILED");
+    return errors == 0 ? 0 : 1;
+}
@@ -21,6 +21,8 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#include <algorithm>
+#include <cassert>
 #include "text_entry_box.h"
 #include "hid_keyboard.h"
 
@@ -28,12 +30,19 @@ rppicomidi::Text_entry_box::Text_entry_box(Mono_graphics& screen_, const char* t
         const std::string illegal_chars_, View* cb_context_, void (*done_cb_)(View*, bool ), bool hide_typing_) :
     View{screen_, screen_.get_clip_rect()}, font{screen_.get_font_12()}, title{title_},
     y{(uint8_t)(title.size() ? font.height + 4: 0)}, max_chars{max_chars_},
-    illegal_chars{illegal_chars_}, cb_context{cb_context_}, done_cb{done_cb_}, hide_typing{hide_typing_},
+    illegal_char_bits{0, 0, 0, 0}, cb_context{cb_context_}, done_cb{done_cb_}, hide_typing{hide_typing_},
     cursor_position{0}, chars_per_line{(uint8_t)(screen.get_screen_width()/font.width)},
-    max_lines{(uint8_t)((max_chars/ chars_per_line) + ((max_chars % chars_per_line) != 0))},
-    overwrite_mode{false}, text_ok{false}
+    max_lines{(max_chars/ chars_per_line) + ((max_chars % chars_per_line) != 0)},
+    visible_lines{(uint8_t)std::min<size_t>(max_lines, (screen.get_screen_height() - y) / font.height)},
+    overwrite_mode{false}, text_ok{false}, text_typed{max_chars_}, dirty_first{1}, dirty_last{0},
+    drawn_cursor_position{0}, first_visible_line{0}
 {
-
+    assert(visible_lines > 0);
+    for (auto ch: illegal_chars_) {
+        uint8_t idx = static_cast<uint8_t>(ch);
+        if (idx < 128)
+            illegal_char_bits[idx / 32] |= (1ul << (idx % 32));
+    }
 }
 
 void rppicomidi::Text_entry_box::set_cursor_to_end()
@@ -46,39 +55,93 @@ void rppicomidi::Text_entry_box::set_cursor_to_end()
 
 void rppicomidi::Text_entry_box::set_text(const char* text)
 {
-    text_typed = std::string(text);
-    if (text_typed.size() > max_chars)
-        text_typed = text_typed.substr(0, max_chars);
+    text_typed.assign(text);
+    if (cursor_position > text_typed.size())
+        cursor_position = text_typed.size();
+    // the next render() draws the whole box
+    draw_pending = true;
+}
+
+bool rppicomidi::Text_entry_box::scroll_to_cursor()
+{
+    size_t cursor_line = std::min(cursor_position, max_chars - 1) / chars_per_line;
+    size_t prev_first_visible_line = first_visible_line;
+    if (cursor_line < first_visible_line)
+        first_visible_line = cursor_line;
+    else if (cursor_line >= first_visible_line + visible_lines)
+        first_visible_line = cursor_line - visible_lines + 1;
+    return first_visible_line != prev_first_visible_line;
 }
 
 void rppicomidi::Text_entry_box::draw()
 {
-    uint8_t line = y;
-    uint8_t col = 0;
-    size_t pos = 0;
+    scroll_to_cursor();
     // Clear the text box drawing area
-    screen.draw_rectangle(0, y, screen.get_screen_width(), font.height*max_lines,
+    screen.draw_rectangle(0, y, screen.get_screen_width(), font.height*visible_lines,
         Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
-    // draw the previously typed text with the curson position highlighted
-    for (auto ch: text_typed) {
-        Pixel_state fg, bg;
-        if (pos++ == cursor_position) {
-            fg = Pixel_state::PIXEL_ZERO;
-            bg = Pixel_state::PIXEL_ONE;
+    // draw the visible part of the previously typed text with the curson position highlighted
+    size_t end_pos = std::min((first_visible_line + visible_lines) * chars_per_line, text_typed.size());
+    for (size_t pos = first_visible_line * chars_per_line; pos < end_pos; pos++) {
+        draw_cell(pos);
+    }
+    if (cursor_position >= text_typed.size()) {
+        draw_cell(cursor_position);
+    }
+    drawn_cursor_position = cursor_position;
+    dirty_first = 1;
+    dirty_last = 0;
+}
+
+void rppicomidi::Text_entry_box::draw_cell(size_t pos)
+{
+    size_t line = pos / chars_per_line;
+    if (pos >= max_chars || line < first_visible_line || line >= first_visible_line + visible_lines)
+        return;
+    char ch = pos < text_typed.size() ? text_typed.at(pos) : ' ';
+    bool reverse = pos == cursor_position;
+    screen.draw_character(font, (pos % chars_per_line) * font.width, y + (line - first_visible_line) * font.height, ch,
+        reverse ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE,
+        reverse ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO);
+}
+
+void rppicomidi::Text_entry_box::render()
+{
+    if (draw_pending || scroll_to_cursor()) {
+        draw_pending = false;
+        draw();
+        return;
+    }
+    // only the dirty cells in the visible lines, so the cost does not depend on the text length
+    size_t first = std::max(dirty_first, first_visible_line * chars_per_line);
+    size_t last = std::min(dirty_last, (first_visible_line + visible_lines) * chars_per_line - 1);
+    for (size_t pos = first; pos <= last; pos++) {
+        draw_cell(pos);
+    }
+    if (drawn_cursor_position != cursor_position) {
+        draw_cell(drawn_cursor_position);
+        draw_cell(cursor_position);
+        drawn_cursor_position = cursor_position;
+    }
+    dirty_first = 1;
+    dirty_last = 0;
+}
+
+void rppicomidi::Text_entry_box::invalidate_cells(size_t first, size_t last)
+{
+    if (first <= last) {
+        if (dirty_first > dirty_last) {
+            dirty_first = first;
+            dirty_last = last;
         }
         else {
-            fg = Pixel_state::PIXEL_ONE;
-            bg = Pixel_state::PIXEL_ZERO;
+            if (first < dirty_first)
+                dirty_first = first;
+            if (last > dirty_last)
+                dirty_last = last;
         }
-        screen.draw_character(font, col * font.width, line, ch, fg, bg);
-        if (++col == chars_per_line) {
-            col = 0;
-            line += font.height;
-        }
-    }
-    if (cursor_position >= text_typed.size() && cursor_position < max_chars) {
-        screen.draw_character(font, col * font.width, line, ' ', Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ONE);
     }
+    if (!is_render_deferred())
+        render();
 }
 
 void rppicomidi::Text_entry_box::entry()
@@ -107,35 +170,25 @@ void rppicomidi::Text_entry_box::on_left(uint32_t, bool)
 {
     if (cursor_position > 0) {
         --cursor_position;
+        invalidate_cells(1, 0);
     }
-    draw();
 }
 
 void rppicomidi::Text_entry_box::on_right(uint32_t, bool)
 {
-    if (cursor_position <= text_typed.size()) {
-        if (++cursor_position == max_chars) {
-            cursor_position = max_chars;
-        }
+    // the cursor can move one past the end of the text to append, but not past the last cell
+    if (cursor_position < text_typed.size() && cursor_position + 1 < max_chars) {
+        ++cursor_position;
+        invalidate_cells(1, 0);
     }
-    draw();
 }
 
 void rppicomidi::Text_entry_box::delete_char_at_cursor_position()
 {
-    size_t text_typed_size = text_typed.size();
-    if (cursor_position < text_typed_size) {
-        if (cursor_position == 0) {
-            text_typed = text_typed.substr(1);
-        }
-        else if (cursor_position == text_typed_size - 1) {
-            // delete from the end
-            text_typed = text_typed.substr(0, text_typed_size - 1);
-        }
-        else {
-            text_typed = text_typed.substr(0, cursor_position) + text_typed.substr(cursor_position + 1);
-        }
-        draw();
+    size_t old_size = text_typed.size();
+    if (text_typed.erase(cursor_position)) {
+        // the tail shifted left; the old last character cell is now blank
+        invalidate_cells(cursor_position, old_size - 1);
     }
 }
 
@@ -146,14 +199,12 @@ void rppicomidi::Text_entry_box::on_key(uint8_t key_code, uint8_t modifiers, boo
         case HID_KEY_DELETE:
             if (cursor_position < text_typed.size()) {
                 delete_char_at_cursor_position();
-                draw();
             }
             break;
         case HID_KEY_BACKSPACE:
             if (cursor_position > 0) {
                 --cursor_position;
                 delete_char_at_cursor_position();
-                draw();
             }
             break;
         case HID_KEY_TAB:
@@ -161,40 +212,27 @@ void rppicomidi::Text_entry_box::on_key(uint8_t key_code, uint8_t modifiers, boo
             break;
         case HID_KEY_HOME:
             cursor_position = 0;
-            draw();
+            invalidate_cells(1, 0);
             break;
         case HID_KEY_END:
-            cursor_position = text_typed.size();
-            if (cursor_position >= max_chars) {
-                cursor_position = max_chars - 1;
-            }
+            set_cursor_to_end();
+            invalidate_cells(1, 0);
             break;
         case HID_KEY_INSERT:
             overwrite_mode = !overwrite_mode;
             break;
         default:
         {
-            char ch[2] = {'\0','\0'};
-            ch[0] = Hid_keyboard::translate_keycode(key_code, modifiers);
-            if (ch[0]) {
-                if (overwrite_mode) {
-                    text_typed.at(cursor_position) = ch[0];
+            char ch = Hid_keyboard::translate_keycode(key_code, modifiers);
+            if (ch && is_legal_char(ch)) {
+                if (overwrite_mode && cursor_position < text_typed.size()) {
+                    text_typed.replace(cursor_position, ch);
+                    invalidate_cells(cursor_position, cursor_position);
                 }
-                else if (text_typed.size() < max_chars) {
-                    if (cursor_position == 0) {
-                        // insert from the begining                        
-                        text_typed = std::string(ch) + text_typed;
-                    }
-                    else if (cursor_position == text_typed.size()) {
-                        // append to the end
-                        text_typed += std::string(ch);
-                    }
-                    else {
-                        // insert in the middle of the string
-                        text_typed = text_typed.substr(0, cursor_position)+ std::string(ch) + text_typed.substr(cursor_position);
-                    }
+                else if (text_typed.insert(cursor_position, ch)) {
                     ++cursor_position;
-                    draw();
+                    // the tail shifted right
+                    invalidate_cells(cursor_position - 1, text_typed.size() - 1);
                 }
             }
         }
@@ -24,6 +24,7 @@
 #pragma once
 #include <string>
 #include "view.h"
+#include "gap_buffer.h"
 namespace rppicomidi {
 class Text_entry_box : public View
 {
@@ -36,7 +37,9 @@ public:
      * @param screen_ the Mono_graphics screen to draw on
      * @param title_ a string to label the text entry box. If it is empty,
      * then the box takes the whole screen
-     * @param max_chars_ the maximum number of characters accepted in the text box
+     * @param max_chars_ the maximum number of characters accepted in the text box.
+     * If the text does not fit on the screen, the box shows as many lines as fit
+     * and scrolls to keep the cursor visible.
      * @param illegal_chars_ a string containing characters that will be ignored when typed
      * @param done_cb_ is called when this view exits with the bool argument set true if select was press to exit
      * @param hide_typing_ if true, display '*' instead of the typed character; e.g., for passwords
@@ -44,6 +47,8 @@ public:
     Text_entry_box(Mono_graphics& screen_, const char* title_, size_t max_chars_,
         const std::string illegal_chars_, View* cb_context_, void (*done_cb_)(View*, bool ), bool hide_typing_=false);
     void draw();
+    bool needs_render() { return draw_pending || dirty_first <= dirty_last || drawn_cursor_position != cursor_position; }
+    void render();
     void entry();
     void exit();
     /**
@@ -78,19 +83,57 @@ public:
     void set_cursor_to_end();
 protected:
     void delete_char_at_cursor_position();
+
+    /**
+     * @brief draw the character cell at text position pos; draw the cell
+     * in reverse text if it is at the cursor position
+     */
+    void draw_cell(size_t pos);
+
+    /**
+     * @brief mark the character cells from text position first to last
+     * and the old and new cursor cells as needing a redraw, and redraw
+     * them right away unless View::is_render_deferred()
+     *
+     * @param first the first text position to redraw
+     * @param last the last text position to redraw; if last < first,
+     * only the cursor cells get redrawn
+     */
+    void invalidate_cells(size_t first, size_t last);
+
+    /**
+     * @brief scroll the visible lines so that the cursor line is visible
+     *
+     * @return true if the box scrolled and has to be drawn again
+     */
+    bool scroll_to_cursor();
+
+    /**
+     * @brief check if ch is not one of the illegal characters
+     */
+    bool is_legal_char(char ch) const
+    {
+        uint8_t idx = static_cast<uint8_t>(ch);
+        return idx >= 128 || (illegal_char_bits[idx / 32] & (1ul << (idx % 32))) == 0;
+    }
     const Mono_mono_font font;
     const std::string title;
     const uint8_t y;
     size_t max_chars;
-    const std::string illegal_chars;
+    uint32_t illegal_char_bits[4]; //!< bit (ch % 32) of word (ch / 32) is set if ASCII character ch is illegal
     View* cb_context;
     void (*done_cb)(View*, bool );
     bool hide_typing;
     size_t cursor_position;
     const uint8_t chars_per_line;
-    const uint8_t max_lines;
+    const size_t max_lines;         //!< the number of lines max_chars characters take
+    const uint8_t visible_lines;    //!< the number of lines that fit on the screen
     bool overwrite_mode;
     bool text_ok;
-    std::string text_typed;
+    Gap_buffer text_typed;
+    size_t dirty_first;             //!< the first text position render() has to redraw
+    size_t dirty_last;              //!< the last text position render() has to redraw; less than dirty_first if none
+    size_t drawn_cursor_position;   //!< the text position where the cursor was last drawn
+    size_t first_visible_line;      //!< the line of text drawn at the top of the box
 };
 }
\ No newline at end of file
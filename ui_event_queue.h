@@ -0,0 +1,170 @@
+/**
+ * @file ui_event_queue.h
+ * @brief these classes describe UI input events and a lock-free queue that
+ * passes them from an interrupt handler, a USB callback or another
+ * thread to the main loop.
+ *
+ * The queue supports exactly one producer and one consumer. The
+ * producer only writes the head index and the consumer only writes
+ * the tail index, so neither side ever waits for the other and no
+ * atomic read-modify-write instructions are required. This matters on
+ * the RP2040 because the Cortex-M0+ does not have them. The code only
+ * depends on std::atomic, so it also runs on a Linux host with
+ * std::thread producers and consumers.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+namespace rppicomidi
+{
+struct Ui_event
+{
+    enum Type : uint8_t {
+        increment,  //!< View_manager::on_increment()
+        decrement,  //!< View_manager::on_decrement()
+        left,       //!< View_manager::on_left()
+        right,      //!< View_manager::on_right()
+        select,     //!< View_manager::on_select()
+        back,       //!< View_manager::on_back()
+        home,       //!< View_manager::go_home()
+        key,        //!< View_manager::on_key()
+    };
+    Ui_event() : Ui_event{select} {}
+
+    /**
+     * @brief Construct a new Ui_event object for any type except key
+     *
+     * @param type_ the event type
+     * @param delta_ the number of increments for increment, decrement, left and right
+     * @param is_shifted_ true if the Shift button was held for increment, decrement, left and right
+     */
+    Ui_event(Type type_, uint32_t delta_=0, bool is_shifted_=false) :
+        delta{delta_}, type{type_}, is_shifted{is_shifted_}, key_code{0}, modifiers{0}, pressed{false} {}
+
+    /**
+     * @brief Construct a new Ui_event object for a key event
+     */
+    Ui_event(uint8_t key_code_, uint8_t modifiers_, bool pressed_) :
+        delta{0}, type{key}, is_shifted{false}, key_code{key_code_}, modifiers{modifiers_}, pressed{pressed_} {}
+
+    /**
+     * @brief check if the delta of next can be added to the delta of this event
+     */
+    bool can_merge(const Ui_event& next) const
+    {
+        return type <= right && type == next.type && is_shifted == next.is_shifted;
+    }
+
+    uint32_t delta;
+    Type type;
+    bool is_shifted;
+    uint8_t key_code;
+    uint8_t modifiers;
+    bool pressed;
+};
+
+/**
+ * @brief a single producer, single consumer lock-free ring buffer of Ui_event objects
+ *
+ * @tparam capacity_ the maximum number of events in the queue; must be a power of 2
+ */
+template<size_t capacity_>
+class Ui_event_queue
+{
+public:
+    static_assert(capacity_ > 0 && (capacity_ & (capacity_ - 1)) == 0, "capacity_ must be a power of 2");
+    Ui_event_queue() : head{0}, tail{0} {}
+    Ui_event_queue(const Ui_event_queue&) = delete;
+    Ui_event_queue& operator=(const Ui_event_queue&) = delete;
+
+    /**
+     * @brief add an event to the queue; only call from the producer
+     *
+     * @return false if the queue is full and the event was dropped
+     */
+    bool push(const Ui_event& event)
+    {
+        uint32_t write_idx = head.load(std::memory_order_relaxed);
+        if (write_idx - tail.load(std::memory_order_acquire) >= capacity_)
+            return false;
+        events[write_idx & (capacity_ - 1)] = event;
+        head.store(write_idx + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief copy the oldest event in the queue without removing it; only call from the consumer
+     *
+     * @return false if the queue is empty
+     */
+    bool peek(Ui_event& event)
+    {
+        uint32_t read_idx = tail.load(std::memory_order_relaxed);
+        if (read_idx == head.load(std::memory_order_acquire))
+            return false;
+        event = events[read_idx & (capacity_ - 1)];
+        return true;
+    }
+
+    /**
+     * @brief remove the oldest event from the queue; only call from the consumer
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(Ui_event& event)
+    {
+        if (!peek(event))
+            return false;
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief remove the oldest event from the queue, and then merge into it
+     * every event that follows it and has the same type and shift state;
+     * only call from the consumer
+     *
+     * @return false if the queue is empty
+     */
+    bool pop_merged(Ui_event& event)
+    {
+        if (!pop(event))
+            return false;
+        Ui_event next;
+        while (peek(next) && event.can_merge(next)) {
+            event.delta += next.delta;
+            pop(next);
+        }
+        return true;
+    }
+
+    bool is_empty() { return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire); }
+private:
+    Ui_event events[capacity_];
+    std::atomic<uint32_t> head;     //!< the number of events ever pushed; only the producer writes it
+    std::atomic<uint32_t> tail;     //!< the number of events ever popped; only the consumer writes it
+};
+}
@@ -48,7 +48,7 @@ public:
      * @param rect the bounding rectangle of the view
      */
     View(Mono_graphics& screen_, const Rectangle& rect_) :
-        screen{screen_}, view_rect{rect_}, has_focus{false} {}
+        screen{screen_}, view_rect{rect_}, has_focus{false}, draw_pending{false} {}
     virtual ~View() = default;
 
     /**
@@ -56,6 +56,55 @@ public:
      */
     virtual void draw()=0;
 
+    /**
+     * @brief mark the whole view as needing draw().
+     *
+     * If rendering is not deferred, then draw it right away. Otherwise, the
+     * View_manager draws it the next time it calls render().
+     */
+    void invalidate()
+    {
+        draw_pending = true;
+        if (!is_render_deferred())
+            render();
+    }
+
+    /**
+     * @brief check if render() has anything to draw
+     *
+     * @return true if the view or part of the view needs to be drawn
+     */
+    virtual bool needs_render() { return draw_pending; }
+
+    /**
+     * @brief draw whatever changed in the view since the last time it was drawn
+     *
+     * Views that can redraw only part of the view should override this
+     * function and needs_render()
+     */
+    virtual void render()
+    {
+        if (draw_pending) {
+            draw_pending = false;
+            draw();
+        }
+    }
+
+    /**
+     * @brief check if views should wait for View_manager::render() to draw
+     *
+     * @return true if invalidate() only marks the view as needing to be drawn;
+     * false if invalidate() draws the view right away.
+     */
+    static bool is_render_deferred() { return render_deferred_flag(); }
+
+    /**
+     * @brief choose if invalidate() draws right away or waits for View_manager::render()
+     *
+     * @note View_manager::set_frame_interval_ms() calls this function
+     */
+    static void set_render_deferred(bool deferred) { render_deferred_flag() = deferred; }
+
     /**
      * @brief screen manager calls this function prior to calling draw()
      *
@@ -132,8 +181,34 @@ public:
 
     virtual bool get_has_focus() {return has_focus; }
 protected:
+    /**
+     * @brief draw a vertical scroll bar on the right side of the view_rect
+     *
+     * @param first_row the number of rows scrolled past the top of the view
+     * @param rows_shown the number of rows the view is showing
+     * @param total_rows the total number of rows that could be shown
+     */
+    void draw_scroll_bar(int first_row, int rows_shown, int total_rows)
+    {
+        uint8_t scroll_bar_width = 4;
+        uint8_t scroll_bar_x = screen.get_screen_width()-scroll_bar_width;
+        screen.draw_rectangle(scroll_bar_x, view_rect.y_upper_left, scroll_bar_width, view_rect.height,
+            Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ZERO);
+        uint8_t rect_height = rows_shown * view_rect.height / total_rows;
+        uint8_t rect_y = (first_row * view_rect.height / total_rows) + view_rect.y_upper_left;
+        screen.draw_rectangle(scroll_bar_x, rect_y, scroll_bar_width, rect_height,
+            Pixel_state::PIXEL_ONE, Pixel_state::PIXEL_ONE);
+    }
+
     Mono_graphics& screen;
     Rectangle view_rect;
     bool has_focus;
+    bool draw_pending; //!< true if invalidate() was called and render() has not called draw() yet
+private:
+    static bool& render_deferred_flag()
+    {
+        static bool render_deferred = false;
+        return render_deferred;
+    }
 };
 }
\ No newline at end of file
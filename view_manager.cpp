@@ -26,6 +26,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#include "pico/stdlib.h"
 #include "view_manager.h"
 
 void rppicomidi::View_manager::push_view(View* new_view)
@@ -38,7 +39,7 @@ void rppicomidi::View_manager::push_view(View* new_view)
     (void)result;
     #endif
     assert(result != View::Select_result::exit_view); //pushing a new view view should not immediately exit
-    (*current_view)->draw();
+    (*current_view)->invalidate();
 }
 
 void rppicomidi::View_manager::pop_view()
@@ -48,7 +49,7 @@ void rppicomidi::View_manager::pop_view()
         view_stack.pop_back();
         current_view = view_stack.end() - 1;
         (*current_view)->entry();
-        (*current_view)->draw();
+        (*current_view)->invalidate();
     }
     
 }
@@ -62,7 +63,7 @@ void rppicomidi::View_manager::go_home()
             current_view = view_stack.end() - 1;
         } while (current_view != view_stack.begin());
         (*current_view)->entry();
-        (*current_view)->draw();
+        (*current_view)->invalidate();
     }
 }
 
@@ -92,4 +93,83 @@ void rppicomidi::View_manager::on_back()
             push_view(new_view_);
         }
     }
-}
\ No newline at end of file
+}
+
+void rppicomidi::View_manager::set_frame_interval_ms(uint32_t frame_interval_ms)
+{
+    frame_interval_us = static_cast<uint64_t>(frame_interval_ms) * 1000ull;
+    View::set_render_deferred(frame_interval_ms != 0);
+    if (frame_interval_ms == 0 && current_view != view_stack.end()) {
+        // draw anything left over from deferred mode
+        (*current_view)->render();
+    }
+}
+
+bool rppicomidi::View_manager::render()
+{
+    bool drew = false;
+    if (current_view != view_stack.end() && (*current_view)->needs_render()) {
+        uint64_t now = to_us_since_boot(get_absolute_time());
+        if (now - last_frame_us >= frame_interval_us) {
+            last_frame_us = now;
+            (*current_view)->render();
+            drew = true;
+            handoff_pending = frame_handoff != nullptr;
+        }
+    }
+    if (handoff_pending && frame_handoff->publish(handoff_canvas)) {
+        handoff_pending = false;
+    }
+    return drew;
+}
+
+bool rppicomidi::View_manager::post_event(const Ui_event& event, Input_source source)
+{
+    assert(source < num_input_sources);
+    if (input_queued)
+        return event_queues[source].push(event);
+    dispatch(event);
+    return true;
+}
+
+void rppicomidi::View_manager::dispatch_pending()
+{
+    Ui_event event;
+    for (auto& event_queue: event_queues) {
+        while (event_queue.pop_merged(event)) {
+            dispatch(event);
+        }
+    }
+}
+
+void rppicomidi::View_manager::dispatch(const Ui_event& event)
+{
+    switch (event.type) {
+    case Ui_event::increment:
+        on_increment(event.delta, event.is_shifted);
+        break;
+    case Ui_event::decrement:
+        on_decrement(event.delta, event.is_shifted);
+        break;
+    case Ui_event::left:
+        on_left(event.delta, event.is_shifted);
+        break;
+    case Ui_event::right:
+        on_right(event.delta, event.is_shifted);
+        break;
+    case Ui_event::select:
+        on_select();
+        break;
+    case Ui_event::back:
+        on_back();
+        break;
+    case Ui_event::home:
+        go_home();
+        break;
+    case Ui_event::key:
+        on_key(event.key_code, event.modifiers, event.pressed);
+        break;
+    default:
+        break;
+    }
+}
@@ -29,11 +29,14 @@
 #pragma once
 #include <vector>
 #include "view.h"
+#include "ui_event_queue.h"
+#include "frame_handoff.h"
 namespace rppicomidi {
 class View_manager
 {
 public:
-    View_manager() { current_view = view_stack.end(); }
+    View_manager() : frame_interval_us{0}, last_frame_us{0}, input_queued{false},
+        frame_handoff{nullptr}, handoff_canvas{nullptr}, handoff_pending{false} { current_view = view_stack.end(); }
 
     /**
      * @brief make the new view the current view
@@ -115,9 +118,103 @@ public:
      * @param pressed is true if the key was pressed and false if it was released
      */
     void on_key(uint8_t key_code, uint8_t modifiers, bool pressed) {if (current_view != view_stack.end()) (*current_view)->on_key(key_code, modifiers, pressed); }
+
+    /**
+     * @brief Set the minimum time between the frames that render() draws
+     *
+     * @param frame_interval_ms the minimum number of milliseconds between frames.
+     * If 0, which is the default, views draw as soon as they change and calling
+     * render() is not required. Otherwise, views and menu items only mark what
+     * changed, and the application must call render() from its main loop. A fast
+     * encoder spin or key auto-repeat then costs at most one redraw per frame.
+     */
+    void set_frame_interval_ms(uint32_t frame_interval_ms);
+
+    /**
+     * @brief draw whatever changed in the current view since the last frame
+     * if at least the frame interval has passed since the last frame
+     *
+     * @return true if anything was drawn. The application should then send
+     * the screen canvas to the display, unless it set a frame handoff.
+     */
+    bool render();
+
+    /**
+     * @brief make render() publish every frame it draws to another core or thread
+     *
+     * After render() draws a frame, it copies the canvas to the frame handoff
+     * double buffer. If the consumer is still busy with the previous frame,
+     * the next call to render() tries again. The consumer acquires each frame
+     * and sends it to the display.
+     *
+     * @param frame_handoff_ the frame handoff double buffer, or nullptr to stop
+     * publishing frames
+     * @param canvas_ the screen canvas the views draw into; it must be
+     * frame_handoff_->get_frame_size() bytes long
+     * @note only frames render() draws are published, so also call
+     * set_frame_interval_ms() with a non-zero interval
+     */
+    void set_frame_handoff(Frame_handoff_base* frame_handoff_, const uint8_t* canvas_)
+    {
+        frame_handoff = frame_handoff_;
+        handoff_canvas = canvas_;
+        handoff_pending = false;
+    }
+
+    /**
+     * @brief choose if post_event() queues events for dispatch_pending()
+     *
+     * @param queued true to queue events posted with post_event() until the
+     * application calls dispatch_pending() from its main loop. false, the
+     * default, to dispatch them to the current view right away.
+     */
+    void set_input_queued(bool queued) { input_queued = queued; }
+
+    /**
+     * @brief the input drivers that post events. Each one has its own
+     * single producer queue, so different drivers may post from different
+     * interrupt handlers, USB callbacks or threads.
+     */
+    enum Input_source : uint8_t {
+        button_input,       //!< Nav_buttons
+        keyboard_input,     //!< the HID keyboard driver
+        num_input_sources,
+    };
+
+    /**
+     * @brief report a UI input event. Input drivers call this function
+     * instead of calling on_increment(), on_select(), etc. directly.
+     *
+     * If set_input_queued(true) was called, this function only adds the event
+     * to the lock-free queue for source, so it is safe to call from one
+     * interrupt handler, USB callback or thread per source other than the one
+     * that calls dispatch_pending(). Two contexts must never post events for
+     * the same source.
+     *
+     * @param event the event
+     * @param source the input driver that posts the event
+     * @return false if the queue was full and the event was dropped
+     */
+    bool post_event(const Ui_event& event, Input_source source=button_input);
+
+    /**
+     * @brief dispatch all events post_event() queued to the current view,
+     * one source at a time. Consecutive increment, decrement, left or right
+     * events from the same source with the same shift state are merged into
+     * a single event with the sum of the deltas.
+     */
+    void dispatch_pending();
 private:
+    void dispatch(const Ui_event& event);
     //void switch_current_view();
     std::vector<View*> view_stack;
     std::vector<View*>::iterator current_view;
+    uint64_t frame_interval_us;
+    uint64_t last_frame_us;   //!< the time render() last drew a frame
+    bool input_queued;
+    Ui_event_queue<32> event_queues[num_input_sources];    //!< one queue per Input_source
+    Frame_handoff_base* frame_handoff;
+    const uint8_t* handoff_canvas;
+    bool handoff_pending;   //!< true if render() drew a frame that has not been published yet
 };
 }
@@ -0,0 +1,241 @@
+/**
+ * @file virtual_menu.cpp
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "virtual_menu.h"
+
+rppicomidi::Virtual_menu::Virtual_menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_,
+    Virtual_menu_source& source_) :
+    View(screen_, Rectangle{0,y_,screen_.get_screen_width(), static_cast<uint8_t>(screen_.get_screen_height() - y_)}),
+    menu_font{menu_font_}, source{source_}, current_row{0}, scroll_offset{0}, dirty_rows{0}
+{
+    max_visisble_items = view_rect.height / menu_font.height;
+    assert(max_visisble_items <= 32); // dirty_rows has one bit per row
+    // allocate all of the row objects up front; they get recycled as the menu scrolls
+    rows.reserve(max_visisble_items);
+    for (uint8_t pos = 0; pos < max_visisble_items; pos++) {
+        rows.emplace_back(screen_, menu_font_);
+    }
+}
+
+void rppicomidi::Virtual_menu::entry()
+{
+    has_focus = true;
+    for (auto& row: rows) {
+        row.set_editing(false);
+        row.exit();
+    }
+}
+
+void rppicomidi::Virtual_menu::exit()
+{
+    has_focus = false;
+    for (auto& row: rows) {
+        row.set_editing(false);
+        row.exit();
+    }
+}
+
+void rppicomidi::Virtual_menu::reload()
+{
+    size_t num_rows = source.get_num_rows();
+    if (current_row >= num_rows)
+        current_row = num_rows == 0 ? 0 : num_rows - 1;
+    // fill the screen with rows if there are enough of them
+    size_t max_scroll_offset = num_rows > max_visisble_items ? num_rows - max_visisble_items : 0;
+    if (scroll_offset > max_scroll_offset)
+        scroll_offset = max_scroll_offset;
+    if (scroll_offset > current_row)
+        scroll_offset = current_row;
+    invalidate();
+}
+
+void rppicomidi::Virtual_menu::draw()
+{
+    draw_pending = false;
+    dirty_rows = 0;
+    // Clear the bounding rectangle
+    screen.draw_rectangle(view_rect, Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+    size_t num_rows = source.get_num_rows();
+    size_t rows_drawn = 0;
+    for (auto& row: rows) {
+        size_t idx = scroll_offset + rows_drawn;
+        if (idx < num_rows) {
+            source.bind_row(idx, row);
+            row.set_highlighted(idx == current_row);
+            row.draw(rows_drawn*menu_font.height+view_rect.y_upper_left);
+            ++rows_drawn;
+        }
+        else {
+            row.exit();
+        }
+    }
+    if (rows_drawn < num_rows) {
+        draw_scroll_bar(scroll_offset, rows_drawn, num_rows);
+    }
+}
+
+void rppicomidi::Virtual_menu::render()
+{
+    if (draw_pending)
+        draw();
+    else if (dirty_rows != 0)
+        redraw_dirty_rows();
+}
+
+void rppicomidi::Virtual_menu::invalidate_row(size_t pos)
+{
+    if (pos < rows.size()) {
+        dirty_rows |= (1ul << pos);
+        if (!is_render_deferred())
+            redraw_dirty_rows();
+    }
+}
+
+void rppicomidi::Virtual_menu::redraw_dirty_rows()
+{
+    size_t num_rows = source.get_num_rows();
+    for (size_t pos = 0; dirty_rows != 0; pos++) {
+        if (dirty_rows & (1ul << pos)) {
+            dirty_rows &= ~(1ul << pos);
+            if (scroll_offset + pos < num_rows) {
+                source.bind_row(scroll_offset + pos, rows[pos]);
+                rows[pos].set_highlighted(scroll_offset + pos == current_row);
+                rows[pos].redraw();
+            }
+        }
+    }
+}
+
+void rppicomidi::Virtual_menu::move_current_row(size_t next_row)
+{
+    size_t prev_row = current_row;
+    size_t prev_scroll_offset = scroll_offset;
+    if (next_row < scroll_offset) {
+        scroll_offset = next_row;
+    }
+    else if (next_row >= scroll_offset + max_visisble_items) {
+        scroll_offset = next_row - max_visisble_items + 1;
+    }
+    current_row = next_row;
+    if (scroll_offset != prev_scroll_offset) {
+        // every row moved
+        invalidate();
+    }
+    else {
+        dirty_rows |= (1ul << (prev_row - scroll_offset));
+        invalidate_row(current_row - scroll_offset);
+    }
+}
+
+int rppicomidi::Virtual_menu::set_current_row_idx(int idx)
+{
+    if (idx >= 0 && idx < static_cast<int>(source.get_num_rows())) {
+        current_row = idx;
+        if (current_row < scroll_offset) {
+            scroll_offset = current_row;
+        }
+        else if (current_row >= scroll_offset + max_visisble_items) {
+            scroll_offset = current_row - max_visisble_items + 1;
+        }
+    }
+    else {
+        idx = -1;
+    }
+    return idx;
+}
+
+void rppicomidi::Virtual_menu::on_decrement(uint32_t delta, bool is_shifted)
+{
+    size_t num_rows = source.get_num_rows();
+    if (delta > 0 && num_rows > 0) {
+        if (has_focus) {
+            if (is_shifted)
+                delta += 5; // down arrow becomes page down
+            size_t last_row = num_rows - 1;
+            size_t next_row = delta > last_row - current_row ? last_row : current_row + delta;
+            if (next_row != current_row)
+                move_current_row(next_row);
+        }
+        else {
+            invalidate_current_row_if(source.on_decrement(current_row, delta, is_shifted));
+        }
+    }
+}
+
+void rppicomidi::Virtual_menu::on_increment(uint32_t delta, bool is_shifted)
+{
+    size_t num_rows = source.get_num_rows();
+    if (delta > 0 && num_rows > 0) {
+        if (has_focus) {
+            if (is_shifted)
+                delta += 5; // up arrow becomes page up
+            size_t next_row = delta > current_row ? 0 : current_row - delta;
+            if (next_row != current_row)
+                move_current_row(next_row);
+        }
+        else {
+            invalidate_current_row_if(source.on_increment(current_row, delta, is_shifted));
+        }
+    }
+}
+
+void rppicomidi::Virtual_menu::on_left(uint32_t delta, bool is_shifted)
+{
+    if (!has_focus && source.get_num_rows() > 0)
+        invalidate_current_row_if(source.on_left(current_row, delta, is_shifted));
+}
+
+void rppicomidi::Virtual_menu::on_right(uint32_t delta, bool is_shifted)
+{
+    if (!has_focus && source.get_num_rows() > 0)
+        invalidate_current_row_if(source.on_right(current_row, delta, is_shifted));
+}
+
+void rppicomidi::Virtual_menu::invalidate_current_row_if(bool changed)
+{
+    if (changed)
+        invalidate_row(current_row - scroll_offset);
+}
+
+rppicomidi::View::Select_result rppicomidi::Virtual_menu::on_select(View** new_view)
+{
+    Select_result result = View::no_op;
+    *new_view = nullptr;
+    if (source.get_num_rows() > 0) {
+        result = source.on_select(current_row, new_view);
+        size_t pos = current_row - scroll_offset;
+        if (result == Select_result::take_focus) {
+            has_focus = false;
+            rows[pos].set_editing(true);
+            invalidate_row(pos);
+        }
+        else if (result == Select_result::give_focus) {
+            has_focus = true;
+            rows[pos].set_editing(false);
+            invalidate_row(pos);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file virtual_menu.h
+ * @brief this class describes a text-based menu that gets its rows from a
+ * data source instead of from a list of Menu_item objects.
+ *
+ * A Menu needs one Menu_item object for every row in the menu. A
+ * Virtual_menu only creates as many Virtual_menu_row objects as fit
+ * on the screen at once. Each time a row scrolls into view, the
+ * Virtual_menu asks the Virtual_menu_source to bind the data for that
+ * row to one of the recycled Virtual_menu_row objects. A menu with
+ * hundreds of rows therefore costs only a few rows of RAM plus whatever
+ * the data source needs to describe the rows.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2022 rppicomidi
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+#include <vector>
+#include <cassert>
+#include "view.h"
+#include "menu_item.h"
+namespace rppicomidi {
+/**
+ * @brief a recycled Menu_item that shows a label and an optional value.
+ *
+ * The value is drawn in reverse text while the row is being edited, the
+ * same way the spinner menu items show the number being edited.
+ */
+class Virtual_menu_row : public Menu_item
+{
+public:
+    Virtual_menu_row(Mono_graphics& screen_, const Mono_mono_font& font_) :
+        Menu_item{"", screen_, font_}, editing{false}, drawn_len{0} { value[0] = '\0'; }
+
+    virtual void draw(uint8_t y_)
+    {
+        // the menu cleared the row before it calls draw()
+        drawn_len = 0;
+        Menu_item::draw(y_);
+    }
+
+    virtual void redraw()
+    {
+        if (last_draw_y < 0 || is_hidden())
+            return;
+        bool reverse_label = is_highlighted() && !editing;
+        bool reverse_value = reverse_label || editing;
+        screen.draw_string(font, 0, last_draw_y, text, text_len,
+            reverse_label ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE,
+            reverse_label ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO);
+        size_t value_len = strlen(value);
+        if (value_len != 0) {
+            screen.draw_string(font, text_len*font.width, last_draw_y, value, value_len,
+                reverse_value ? Pixel_state::PIXEL_ZERO : Pixel_state::PIXEL_ONE,
+                reverse_value ? Pixel_state::PIXEL_ONE : Pixel_state::PIXEL_ZERO);
+        }
+        size_t row_len = text_len + value_len;
+        if (drawn_len > row_len) {
+            // erase the end of the longer label or value drawn before
+            screen.draw_rectangle(row_len*font.width, last_draw_y, (drawn_len - row_len)*font.width, font.height,
+                Pixel_state::PIXEL_ZERO, Pixel_state::PIXEL_ZERO);
+        }
+        drawn_len = row_len;
+    }
+
+    /**
+     * @brief Set the value text drawn after the label text
+     *
+     * @param value_ the new value text; nullptr or "" for no value
+     */
+    void set_value(const char* value_)
+    {
+        if (value_) {
+            strncpy(value, value_, max_value_len);
+            value[max_value_len] = '\0';
+        }
+        else {
+            value[0] = '\0';
+        }
+    }
+    const char* get_value() {return value; }
+    void set_editing(bool editing_) {editing = editing_; }
+    bool is_editing() {return editing; }
+protected:
+    static const uint8_t max_value_len = 10;
+    char value[max_value_len+1];
+    bool editing;
+    size_t drawn_len;   //!< the number of label and value characters the last redraw() drew
+};
+
+/**
+ * @brief the interface a Virtual_menu uses to get the number of rows, the
+ * content of each row, and to pass along UI actions for a row.
+ */
+class Virtual_menu_source
+{
+public:
+    virtual ~Virtual_menu_source() = default;
+
+    /**
+     * @brief Get the number of rows in the menu
+     */
+    virtual size_t get_num_rows() = 0;
+
+    /**
+     * @brief set the text and value of a recycled row object so that it shows row idx
+     *
+     * @param idx the row number from 0 to get_num_rows()-1
+     * @param row the row object to update
+     */
+    virtual void bind_row(size_t idx, Virtual_menu_row& row) = 0;
+
+    /**
+     * @brief the Virtual_menu calls this function when Select is pressed on row idx
+     *
+     * @param idx the row number
+     * @param new_view_ set *new_view_ to the new View if the return value is new_view
+     * @return take_focus to send subsequent increment, decrement, left and right
+     * actions to this object; give_focus to return them to the Virtual_menu
+     */
+    virtual View::Select_result on_select(size_t idx, View** new_view_) { (void)idx; *new_view_ = nullptr; return View::no_op; }
+
+    /**
+     * @brief the Virtual_menu calls these functions for UI actions on row idx
+     * after on_select() returned take_focus
+     *
+     * @return true if the row content changed and the row must be redrawn
+     */
+    virtual bool on_increment(size_t idx, uint32_t delta, bool is_shifted) {(void)idx; (void)delta; (void)is_shifted; return false; }
+    virtual bool on_decrement(size_t idx, uint32_t delta, bool is_shifted) {(void)idx; (void)delta; (void)is_shifted; return false; }
+    virtual bool on_left(size_t idx, uint32_t delta, bool is_shifted) {(void)idx; (void)delta; (void)is_shifted; return false; }
+    virtual bool on_right(size_t idx, uint32_t delta, bool is_shifted) {(void)idx; (void)delta; (void)is_shifted; return false; }
+};
+
+class Virtual_menu : public View
+{
+public:
+    Virtual_menu()=delete;
+    /**
+     * @brief Construct a new Virtual_menu object
+     *
+     * @param screen_ the screen that will render the menu
+     * @param y_ the number of pixels from the top of the screen to start drawing the menu
+     * @param menu_font_ the font to render each row
+     * @param source_ the object that describes the rows of the menu
+     */
+    Virtual_menu(Mono_graphics& screen_, uint8_t y_, const Mono_mono_font& menu_font_, Virtual_menu_source& source_);
+    virtual ~Virtual_menu() = default;
+    virtual void draw();
+    virtual bool needs_render() { return draw_pending || dirty_rows != 0; }
+    virtual void render();
+    virtual void entry();
+    virtual void exit();
+    virtual Select_result on_select(View** new_view);
+    virtual void on_increment(uint32_t delta, bool is_shifted);
+    virtual void on_decrement(uint32_t delta, bool is_shifted);
+    virtual void on_left(uint32_t delta, bool is_shifted);
+    virtual void on_right(uint32_t delta, bool is_shifted);
+
+    /**
+     * @brief Get the current row idx
+     *
+     * @return -1 if the menu has no rows. Otherwise, return the row number from 0.
+     */
+    int get_current_row_idx() { return source.get_num_rows() == 0 ? -1 : static_cast<int>(current_row); }
+
+    /**
+     * @brief make row idx the current row and scroll it into view
+     *
+     * @param idx the new current row
+     * @return idx, or -1 if idx is out of range
+     */
+    int set_current_row_idx(int idx);
+
+    /**
+     * @brief re-read the number of rows and the content of every visible row
+     * from the source and draw the menu again, or with deferred rendering,
+     * on the next render(). Call this function after the data the source
+     * describes changes.
+     */
+    void reload();
+protected:
+    /**
+     * @brief make row next_row the current row and update the display the
+     * way Menu::move_current_item() does
+     */
+    void move_current_row(size_t next_row);
+
+    /**
+     * @brief flag the row object for window position pos as needing a redraw
+     * and redraw it right away unless View::is_render_deferred()
+     */
+    void invalidate_row(size_t pos);
+
+    /**
+     * @brief bind each row object flagged by invalidate_row() to the source,
+     * redraw it, and then clear the flags
+     */
+    void redraw_dirty_rows();
+
+    /**
+     * @brief the increment, decrement, left and right actions call this
+     * function with the result of forwarding the action to the source
+     */
+    void invalidate_current_row_if(bool changed);
+
+    const Mono_mono_font& menu_font;
+    Virtual_menu_source& source;
+    uint8_t max_visisble_items;
+    std::vector<Virtual_menu_row> rows; //!< rows[n] shows the row number scroll_offset+n
+    size_t current_row;
+    size_t scroll_offset;
+    uint32_t dirty_rows; //!< bit n set means rows[n] needs a redraw
+};
+}